@@ -0,0 +1,433 @@
+/*
+ * 控制邏輯效能基準測試 (主機端)
+ * 直接編譯 main/ctrl_logic.c，量測韌體熱路徑在 Linux 上的每次操作耗時，
+ * 並與 host/bench/baseline.csv 比較，超過門檻即判定為效能退步 (exit 1)。
+ *
+ * 為了降低不同機器間 (以及 CPU 變頻) 的差異，比較的是「相對校正迴圈的倍數」(ratio)，
+ * 不是絕對奈秒數；每個樣本都是「校正 - 測試 - 校正」三段相鄰的毫秒級批次，
+ * 取各樣本 ratio 的中位數，單次的排程中斷或其他核心的負載只會影響少數樣本。
+ *
+ * 用法：
+ *   ctrl_bench [--baseline FILE] [--threshold PCT] [--csv FILE] [--json FILE] [--write-baseline FILE]
+ *   門檻預設 25%，亦可用環境變數 BENCH_THRESHOLD 指定。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ctrl_logic.h"
+
+#define REPS         15  // 每項樣本數 (取 ratio 中位數)
+#define EXTRA_ROUNDS 2   // 疑似退步時追加的樣本輪數 (每輪 REPS 個，與原樣本合併重算中位數)
+#define MAX_SAMPLES  (REPS * (1 + EXTRA_ROUNDS))
+#define BATCH_MS     20  // 每個批次至少執行的時間 (毫秒)；迭代次數會自動加倍到達此長度
+#define INPUT_SETS   256 // 模擬輸入組數 (避免編譯器常數折疊)
+#define NAME_MAX_LEN 32
+
+static volatile uint32_t g_sink; // 防止結果被最佳化掉
+
+static uint64_t s_levels[INPUT_SETS];
+static int s_pots[INPUT_SETS][2];
+static io_snapshot_t s_snaps[INPUT_SETS];
+static char s_stream[INPUT_SETS * CTRL_FRAME_MAX];
+static size_t s_stream_len;
+
+/* ==========================================================
+ * 1. 模擬輸入
+ * ========================================================== */
+
+static uint32_t lcg(uint32_t *state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state;
+}
+
+static void sim_inputs_init(void) {
+    uint32_t st = 12345;
+    for (int i = 0; i < INPUT_SETS; i++) {
+        s_levels[i] = ((uint64_t)lcg(&st) << 32) | lcg(&st);
+        s_pots[i][0] = (int)(lcg(&st) % 4096);
+        s_pots[i][1] = (int)(lcg(&st) % 4096);
+        ctrl_snapshot_decode(s_levels[i], s_pots[i][0], s_pots[i][1], &s_snaps[i]);
+    }
+
+    // 預先組好一段連續的 UART 資料流 (解碼測試用)
+    s_stream_len = 0;
+    for (int i = 0; i < INPUT_SETS; i++) {
+        char json[CTRL_STATUS_MAX];
+        int n = ctrl_status_serialize(&s_snaps[i], json, sizeof(json));
+        s_stream_len += ctrl_frame_encode(json, n, s_stream + s_stream_len, sizeof(s_stream) - s_stream_len);
+    }
+}
+
+/* ==========================================================
+ * 2. 正確性檢查 (確保量到的是正確的程式碼)
+ * ========================================================== */
+
+static int sanity_check(void) {
+    io_snapshot_t s;
+    uint64_t levels = (1ULL << A1_1_GPIO) | (1ULL << B4_GPIO) | (1ULL << C1_2_GPIO) | (1ULL << C4_2_GPIO);
+    ctrl_snapshot_decode(levels, 100, 4095, &s);
+
+    char json[CTRL_STATUS_MAX];
+    const char *expect =
+        "{\"A1_1\":1,\"A1_2\":0,\"A2\":0,\"A3\":0,\"A4\":0,"
+        "\"B1_1\":0,\"B1_2\":0,\"B4\":1,\"B5\":0,\"B2_pot\":100,\"B3_pot\":4095,"
+        "\"C1\":[0,1,0,0],\"C2\":[0,0,0,0],\"C3\":[0,0,0,0],\"C4\":[0,1]}";
+    int n = ctrl_status_serialize(&s, json, sizeof(json));
+    if (n < 0 || strcmp(json, expect) != 0) {
+        fprintf(stderr, "sanity: status_serialize mismatch\n  got:    %s\n  expect: %s\n", json, expect);
+        return -1;
+    }
+
+    ctrl_select_t sel;
+    ctrl_select(&s, &sel);
+    if (ctrl_mode_from_a1(s.a1_1, s.a1_2) != CTRL_MODE_MANUAL || sel.src != 3 || sel.idx != 0 || sel.store) {
+        fprintf(stderr, "sanity: mode/select mismatch\n");
+        return -1;
+    }
+
+    // 封包編碼 -> 分段解碼 往返
+    char frame[CTRL_FRAME_MAX];
+    int flen = ctrl_frame_encode(json, n, frame, sizeof(frame));
+    ctrl_frame_decoder_t dec;
+    ctrl_frame_decoder_init(&dec);
+    const char *line = NULL;
+    size_t line_len = 0, pos = 0;
+    while (pos < (size_t)flen && !line) {
+        size_t step = ((size_t)flen - pos < 7) ? (size_t)flen - pos : 7; // 模擬 UART 一次只收到幾個位元組
+        pos += ctrl_frame_decode(&dec, (const uint8_t *)frame + pos, step, &line, &line_len);
+    }
+    if (!line || line_len != (size_t)n || memcmp(line, json, n) != 0) {
+        fprintf(stderr, "sanity: frame round-trip mismatch\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* ==========================================================
+ * 3. 各項基準測試 (每項回傳處理的操作數)
+ * ========================================================== */
+
+// 校正迴圈：固定的整數運算與查表，用來換算 ratio
+static uint32_t bench_calibration(uint32_t iters) {
+    uint32_t st = 1, acc = 0;
+    for (uint32_t i = 0; i < iters; i++) {
+        for (int k = 0; k < 8; k++) acc += (lcg(&st) >> 7) ^ (uint32_t)s_levels[acc % INPUT_SETS];
+    }
+    g_sink = acc;
+    return iters;
+}
+
+static uint32_t bench_snapshot_decode(uint32_t iters) {
+    io_snapshot_t s;
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < iters; i++) {
+        uint32_t k = i % INPUT_SETS;
+        ctrl_snapshot_decode(s_levels[k], s_pots[k][0], s_pots[k][1], &s);
+        acc += s.c3[2] + s.b5;
+    }
+    g_sink = acc;
+    return iters;
+}
+
+static uint32_t bench_mode_select(uint32_t iters) {
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < iters; i++) {
+        const io_snapshot_t *s = &s_snaps[i % INPUT_SETS];
+        ctrl_select_t sel;
+        acc += ctrl_mode_lamps(ctrl_mode_from_a1(s->a1_1, s->a1_2));
+        ctrl_select(s, &sel);
+        acc += sel.idx + sel.src + sel.store;
+    }
+    g_sink = acc;
+    return iters;
+}
+
+static uint32_t bench_status_serialize(uint32_t iters) {
+    char buf[CTRL_STATUS_MAX];
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < iters; i++) {
+        acc += ctrl_status_serialize(&s_snaps[i % INPUT_SETS], buf, sizeof(buf));
+    }
+    g_sink = acc;
+    return iters;
+}
+
+static uint32_t bench_frame_encode(uint32_t iters) {
+    static char json[INPUT_SETS][CTRL_STATUS_MAX];
+    static int json_len[INPUT_SETS];
+    if (json_len[0] == 0) {
+        for (int k = 0; k < INPUT_SETS; k++) json_len[k] = ctrl_status_serialize(&s_snaps[k], json[k], CTRL_STATUS_MAX);
+    }
+    char frame[CTRL_FRAME_MAX];
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < iters; i++) {
+        uint32_t k = i % INPUT_SETS;
+        acc += ctrl_frame_encode(json[k], json_len[k], frame, sizeof(frame));
+        acc += (uint8_t)frame[0];
+    }
+    g_sink = acc;
+    return iters;
+}
+
+// 以 64 bytes 為單位餵入資料流 (模擬 UART RX FIFO)，每個完整封包算一次操作
+static uint32_t bench_frame_decode(uint32_t iters) {
+    ctrl_frame_decoder_t dec;
+    ctrl_frame_decoder_init(&dec);
+    uint32_t frames = 0, acc = 0;
+    while (frames < iters) {
+        size_t pos = 0;
+        while (pos < s_stream_len) {
+            size_t avail = s_stream_len - pos;
+            size_t chunk = avail < 64 ? avail : 64;
+            const char *line;
+            size_t line_len;
+            pos += ctrl_frame_decode(&dec, (const uint8_t *)s_stream + pos, chunk, &line, &line_len);
+            if (line) {
+                frames++;
+                acc += (uint32_t)line_len;
+            }
+        }
+    }
+    g_sink = acc;
+    return frames;
+}
+
+// 完整週期：GPIO 取樣 -> 快照 -> 模式/燈號 -> 選擇 -> /status JSON -> UART 封包
+static uint32_t bench_sample_publish_cycle(uint32_t iters) {
+    char json[CTRL_STATUS_MAX];
+    char frame[CTRL_FRAME_MAX];
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < iters; i++) {
+        uint32_t k = i % INPUT_SETS;
+        io_snapshot_t s;
+        ctrl_snapshot_decode(s_levels[k], s_pots[k][0], s_pots[k][1], &s);
+        uint8_t lamps = ctrl_mode_lamps(ctrl_mode_from_a1(s.a1_1, s.a1_2));
+        s.a2 = (lamps & CTRL_LAMP_A2) != 0;
+        s.a3 = (lamps & CTRL_LAMP_A3) != 0;
+        s.a4 = (lamps & CTRL_LAMP_A4) != 0;
+        ctrl_select_t sel;
+        ctrl_select(&s, &sel);
+        int n = ctrl_status_serialize(&s, json, sizeof(json));
+        acc += ctrl_frame_encode(json, n, frame, sizeof(frame)) + sel.idx;
+    }
+    g_sink = acc;
+    return iters;
+}
+
+typedef struct {
+    const char *name;
+    uint32_t (*fn)(uint32_t iters);
+    uint32_t iters;                 // 起始迭代次數，size_batch() 會加倍到一個批次至少 BATCH_MS
+    double ns_per_op;               // 所有樣本的中位數
+    double ratio;
+    int nsamples;
+    double s_ns[MAX_SAMPLES];
+    double s_ratio[MAX_SAMPLES];
+} bench_t;
+
+static bench_t s_benches[] = {
+    { .name = "calibration",          .fn = bench_calibration,          .iters = 1000 },
+    { .name = "snapshot_decode",      .fn = bench_snapshot_decode,      .iters = 1000 },
+    { .name = "mode_select",          .fn = bench_mode_select,          .iters = 1000 },
+    { .name = "status_serialize",     .fn = bench_status_serialize,     .iters = 1000 },
+    { .name = "frame_encode",         .fn = bench_frame_encode,         .iters = 1000 },
+    { .name = "frame_decode",         .fn = bench_frame_decode,         .iters = 1000 },
+    { .name = "sample_publish_cycle", .fn = bench_sample_publish_cycle, .iters = 1000 },
+};
+#define BENCH_COUNT (sizeof(s_benches) / sizeof(s_benches[0]))
+
+// 以本執行緒的 CPU 時間計時：被其他行程搶占的時間不計入 (單核心或高負載的 CI 主機)
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static double time_once(const bench_t *b) {
+    double t0 = now_ns();
+    uint32_t ops = b->fn(b->iters);
+    return (now_ns() - t0) / ops;
+}
+
+// 將迭代次數加倍，直到一個批次至少 BATCH_MS (計時器解析度與函式呼叫開銷相對可忽略)
+static void size_batch(bench_t *b) {
+    b->fn(b->iters / 10 + 1); // 暖身 (cache / 分支預測)
+    while (b->iters < (1u << 30)) {
+        double t0 = now_ns();
+        b->fn(b->iters);
+        if (now_ns() - t0 >= BATCH_MS * 1e6) break;
+        b->iters *= 2;
+    }
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double median(const double *v, int n) {
+    double tmp[MAX_SAMPLES];
+    memcpy(tmp, v, n * sizeof(v[0]));
+    qsort(tmp, n, sizeof(tmp[0]), cmp_double);
+    return (n % 2) ? tmp[n / 2] : (tmp[n / 2 - 1] + tmp[n / 2]) / 2;
+}
+
+// 追加 REPS 個樣本 (校正 - 測試 - 校正，ratio = 測試 / 前後校正平均)，並以全部樣本的中位數更新結果
+static void add_samples(bench_t *b, const bench_t *calib) {
+    for (int r = 0; r < REPS && b->nsamples < MAX_SAMPLES; r++) {
+        double c0 = time_once(calib);
+        double t = time_once(b);
+        double c1 = time_once(calib);
+        b->s_ns[b->nsamples] = t;
+        b->s_ratio[b->nsamples] = t / ((c0 + c1) / 2);
+        b->nsamples++;
+    }
+    b->ns_per_op = median(b->s_ns, b->nsamples);
+    b->ratio = median(b->s_ratio, b->nsamples);
+}
+
+static void run_bench(bench_t *b, const bench_t *calib) {
+    size_batch(b);
+    b->nsamples = 0;
+    add_samples(b, calib);
+}
+
+/* ==========================================================
+ * 4. 輸出與基準比較
+ * ========================================================== */
+
+static int write_csv(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    fprintf(f, "name,iterations,ns_per_op,ratio\n");
+    for (size_t i = 0; i < BENCH_COUNT; i++) {
+        const bench_t *b = &s_benches[i];
+        fprintf(f, "%s,%u,%.3f,%.4f\n", b->name, b->iters, b->ns_per_op, b->ratio);
+    }
+    fclose(f);
+    return 0;
+}
+
+static int write_json(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    fprintf(f, "{\"results\":[");
+    for (size_t i = 0; i < BENCH_COUNT; i++) {
+        const bench_t *b = &s_benches[i];
+        fprintf(f, "%s{\"name\":\"%s\",\"iterations\":%u,\"ns_per_op\":%.3f,\"ratio\":%.4f}",
+                i ? "," : "", b->name, b->iters, b->ns_per_op, b->ratio);
+    }
+    fprintf(f, "]}\n");
+    fclose(f);
+    return 0;
+}
+
+// 讀取基準檔並逐項判定 (疑似退步的項目會追加樣本)；回傳退步項目數，讀檔失敗回傳 -1
+static int compare_baseline(const char *path, double threshold_pct) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    char line[256];
+    char names[BENCH_COUNT][NAME_MAX_LEN];
+    double ratios[BENCH_COUNT];
+    size_t count = 0;
+    while (fgets(line, sizeof(line), f) && count < BENCH_COUNT) {
+        char name[NAME_MAX_LEN];
+        double ns, ratio;
+        if (sscanf(line, "%31[^,],%*u,%lf,%lf", name, &ns, &ratio) != 3) continue; // 略過標題列
+        strcpy(names[count], name);
+        ratios[count++] = ratio;
+    }
+    fclose(f);
+
+    int regressions = 0;
+    printf("\nBaseline: %s (threshold %.1f%%)\n", path, threshold_pct);
+    for (size_t i = 0; i < BENCH_COUNT; i++) {
+        bench_t *b = &s_benches[i];
+        if (strcmp(b->name, "calibration") == 0) continue;
+
+        size_t j = 0;
+        while (j < count && strcmp(names[j], b->name) != 0) j++;
+        if (j == count) {
+            printf("[  NEW   ] %-22s ratio %8.3f\n", b->name, b->ratio);
+            continue;
+        }
+        double delta = (b->ratio / ratios[j] - 1.0) * 100.0;
+        // 疑似退步：追加樣本後以合併的中位數重新判定 (持續存在的退步不會因此消失)
+        for (int k = 0; k < EXTRA_ROUNDS && delta > threshold_pct; k++) {
+            add_samples(b, &s_benches[0]);
+            delta = (b->ratio / ratios[j] - 1.0) * 100.0;
+        }
+        const char *verdict = "   OK   ";
+        if (delta > threshold_pct) {
+            verdict = "REGRESS ";
+            regressions++;
+        } else if (delta < -threshold_pct) {
+            verdict = "IMPROVED";
+        }
+        printf("[%s] %-22s ratio %8.3f  baseline %8.3f  (%+.1f%%)\n", verdict, b->name, b->ratio, ratios[j], delta);
+    }
+    return regressions;
+}
+
+int main(int argc, char **argv) {
+    const char *baseline = NULL, *csv = NULL, *json = NULL, *write_base = NULL;
+    const char *env = getenv("BENCH_THRESHOLD");
+    double threshold = env ? atof(env) : 25.0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *next = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (!next) {
+            fprintf(stderr, "missing value for %s\n", argv[i]);
+            return 2;
+        }
+        if (strcmp(argv[i], "--baseline") == 0) baseline = next;
+        else if (strcmp(argv[i], "--threshold") == 0) threshold = atof(next);
+        else if (strcmp(argv[i], "--csv") == 0) csv = next;
+        else if (strcmp(argv[i], "--json") == 0) json = next;
+        else if (strcmp(argv[i], "--write-baseline") == 0) write_base = next;
+        else {
+            fprintf(stderr, "unknown option: %s\n", argv[i]);
+            return 2;
+        }
+        i++;
+    }
+
+    sim_inputs_init();
+    if (sanity_check() != 0) return 2;
+
+    size_batch(&s_benches[0]); // 校正迴圈的批次長度先固定，之後各項共用
+    for (size_t i = 0; i < BENCH_COUNT; i++) {
+        bench_t *b = &s_benches[i];
+        run_bench(b, &s_benches[0]);
+        printf("%-22s %10.2f ns/op  ratio %8.3f\n", b->name, b->ns_per_op, b->ratio);
+    }
+
+    int regressions = 0;
+    if (baseline) {
+        regressions = compare_baseline(baseline, threshold);
+        if (regressions < 0) return 2;
+    }
+
+    if (csv && write_csv(csv) != 0) return 2;
+    if (json && write_json(json) != 0) return 2;
+    if (write_base && write_csv(write_base) != 0) return 2;
+
+    if (regressions > 0) {
+        printf("\n%d benchmark(s) regressed more than %.1f%%\n", regressions, threshold);
+        return 1;
+    }
+    if (baseline) printf("\nNo regressions.\n");
+    return 0;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+/*
+ * 主機端模擬用的最小 driver/gpio.h
+ * 只提供 io_config.h 需要的型別，讓 main/ 的純邏輯原始碼可以在 Linux 上編譯。
+ */
+
+typedef int gpio_num_t;
@@ -0,0 +1,10 @@
+#pragma once
+
+/*
+ * 主機端模擬用的最小 esp_adc/adc_oneshot.h (僅提供 io_config.h 用到的通道常數)
+ */
+
+typedef enum {
+    ADC_CHANNEL_0,
+    ADC_CHANNEL_1,
+} adc_channel_t;
@@ -0,0 +1,29 @@
+#pragma once
+
+/*
+ * host/ 單元測試共用的最小檢查巨集
+ *
+ *   CHECK(cond);                       // 失敗時印出位置並累計，不中斷後續檢查
+ *   return check_report("power_policy"); // 放在 main() 結尾：全部通過回傳 0，否則 1
+ */
+
+#include <stdio.h>
+
+static int s_check_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+        s_check_failures++; \
+    } \
+} while (0)
+
+static inline int check_report(const char *suite)
+{
+    if (s_check_failures) {
+        fprintf(stderr, "%s: %d check(s) failed\n", suite, s_check_failures);
+        return 1;
+    }
+    printf("%s: all checks passed\n", suite);
+    return 0;
+}
@@ -0,0 +1,153 @@
+/*
+ * UART 封包解碼 (main/ctrl_logic.c 的 ctrl_frame_decode) 主機端測試
+ * 著重在超長行丟棄、丟棄後的復原，以及被切開的 '\n'。
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ctrl_logic.h"
+#include "check.h"
+
+#define MAX_LINES 8
+
+// 收集解出的行 (複製一份，因為 *line 只在下次呼叫前有效)
+typedef struct {
+    int count;
+    size_t len[MAX_LINES];
+    char text[MAX_LINES][CTRL_FRAME_MAX + 1];
+} lines_t;
+
+// 依解碼器的呼叫慣例把一段資料全部餵完
+static void feed(ctrl_frame_decoder_t *d, const char *data, size_t len, lines_t *out) {
+    size_t pos = 0;
+    while (pos < len) {
+        const char *line;
+        size_t line_len;
+        size_t used = ctrl_frame_decode(d, (const uint8_t *)data + pos, len - pos, &line, &line_len);
+        CHECK(used > 0 && used <= len - pos);
+        if (used == 0) return;
+        pos += used;
+        if (line && out->count < MAX_LINES) {
+            memcpy(out->text[out->count], line, line_len);
+            out->text[out->count][line_len] = '\0';
+            out->len[out->count] = line_len;
+            out->count++;
+        }
+    }
+}
+
+// 一次餵入多行
+static void test_multiple_lines(void) {
+    ctrl_frame_decoder_t d;
+    lines_t got = {0};
+    ctrl_frame_decoder_init(&d);
+
+    const char *in = "{\"a\":1}\n\n{\"b\":2}\n";
+    feed(&d, in, strlen(in), &got);
+    CHECK(got.count == 3);
+    CHECK(strcmp(got.text[0], "{\"a\":1}") == 0);
+    CHECK(got.len[1] == 0); // 空行也回報 (長度 0)
+    CHECK(strcmp(got.text[2], "{\"b\":2}") == 0);
+}
+
+// '\n' 落在下一段：前一段只累積、不回報
+static void test_split_newline(void) {
+    ctrl_frame_decoder_t d;
+    lines_t got = {0};
+    ctrl_frame_decoder_init(&d);
+
+    feed(&d, "{\"cmd\":", 7, &got);
+    feed(&d, "\"stop\"}", 7, &got);
+    CHECK(got.count == 0);
+    feed(&d, "\n", 1, &got);
+    CHECK(got.count == 1);
+    CHECK(strcmp(got.text[0], "{\"cmd\":\"stop\"}") == 0);
+
+    // 換行後緊接下一行的開頭
+    feed(&d, "x\ny", 3, &got);
+    feed(&d, "z\n", 2, &got);
+    CHECK(got.count == 3);
+    CHECK(strcmp(got.text[1], "x") == 0);
+    CHECK(strcmp(got.text[2], "yz") == 0);
+}
+
+// 剛好 CTRL_FRAME_MAX 的行可以完整收到
+static void test_line_at_limit(void) {
+    static char in[CTRL_FRAME_MAX + 1];
+    ctrl_frame_decoder_t d;
+    lines_t got = {0};
+    ctrl_frame_decoder_init(&d);
+
+    memset(in, 'a', CTRL_FRAME_MAX);
+    in[CTRL_FRAME_MAX] = '\n';
+    feed(&d, in, sizeof(in), &got);
+    CHECK(got.count == 1);
+    CHECK(got.len[0] == CTRL_FRAME_MAX);
+}
+
+// 超過 CTRL_FRAME_MAX 的行整行丟棄，下一行正常收到
+static void test_overflow_discard_and_recover(void) {
+    static char in[CTRL_FRAME_MAX + 2];
+    ctrl_frame_decoder_t d;
+    lines_t got = {0};
+    ctrl_frame_decoder_init(&d);
+
+    memset(in, 'b', CTRL_FRAME_MAX + 1);
+    in[CTRL_FRAME_MAX + 1] = '\n';
+    feed(&d, in, sizeof(in), &got);
+    CHECK(got.count == 0);
+
+    feed(&d, "ok\n", 3, &got);
+    CHECK(got.count == 1);
+    CHECK(strcmp(got.text[0], "ok") == 0);
+}
+
+// 超長行分成多段送入 (溢位發生在中間某段)，且 '\n' 與下一行同一段
+static void test_overflow_across_chunks(void) {
+    static char chunk[100];
+    ctrl_frame_decoder_t d;
+    lines_t got = {0};
+    ctrl_frame_decoder_init(&d);
+
+    memset(chunk, 'c', sizeof(chunk));
+    for (int i = 0; i < 8; i++) feed(&d, chunk, sizeof(chunk), &got); // 800 bytes > CTRL_FRAME_MAX
+    CHECK(got.count == 0);
+
+    feed(&d, "ccc\nnext\n", 9, &got);
+    CHECK(got.count == 1);
+    CHECK(strcmp(got.text[0], "next") == 0);
+
+    // 溢位狀態已清除：之後的切開換行仍正常
+    feed(&d, "tail", 4, &got);
+    feed(&d, "\n", 1, &got);
+    CHECK(got.count == 2);
+    CHECK(strcmp(got.text[1], "tail") == 0);
+}
+
+// encode -> decode 來回
+static void test_round_trip(void) {
+    char frame[CTRL_FRAME_MAX];
+    ctrl_frame_decoder_t d;
+    lines_t got = {0};
+    ctrl_frame_decoder_init(&d);
+
+    const char *payload = "{\"A1_1\":1}";
+    int n = ctrl_frame_encode(payload, strlen(payload), frame, sizeof(frame));
+    CHECK(n == (int)strlen(payload) + 1);
+    feed(&d, frame, (size_t)n, &got);
+    CHECK(got.count == 1);
+    CHECK(strcmp(got.text[0], payload) == 0);
+
+    CHECK(ctrl_frame_encode(payload, strlen(payload), frame, strlen(payload)) == -1);
+}
+
+int main(void) {
+    test_multiple_lines();
+    test_split_newline();
+    test_line_at_limit();
+    test_overflow_discard_and_recover();
+    test_overflow_across_chunks();
+    test_round_trip();
+
+    return check_report("ctrl_frame");
+}
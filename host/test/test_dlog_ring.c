@@ -0,0 +1,196 @@
+/*
+ * 延遲式日誌環形緩衝區 (main/dlog_ring.c) 主機端測試
+ * 讀取端的覆寫/寫入中判定、drain 的追趕與遺失計數，以及匯出檔的產生與解碼。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dlog_ring.h"
+#include "check.h"
+
+#define SLOTS 8
+
+static dlog_record_t s_slots[SLOTS];
+
+static void put_n(dlog_ring_t *r, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t seq = dlog_ring_head(r);
+        dlog_ring_put(r, 1000 + seq, 0, DLOG_BENCH, 1, (int32_t)seq, 0, 0, 0);
+    }
+}
+
+// drain 的 sink：記下收到的參數 (= 寫入時的序號)
+typedef struct {
+    int count;
+    int32_t seen[64];
+} collect_t;
+
+static void collect(const dlog_record_t *rec, void *ctx) {
+    collect_t *c = (collect_t *)ctx;
+    if (c->count < 64) c->seen[c->count] = rec->args[0];
+    c->count++;
+}
+
+// 讀取結果：正常 / 寫入中 / 已覆寫
+static void test_read_classification(void) {
+    dlog_ring_t r;
+    dlog_record_t rec;
+    dlog_ring_init(&r, s_slots, SLOTS);
+
+    CHECK(dlog_ring_read(&r, 0, &rec) == DLOG_READ_PENDING); // 尚未寫入 (seq == 0)
+
+    put_n(&r, 3);
+    CHECK(dlog_ring_read(&r, 2, &rec) == DLOG_READ_OK);
+    CHECK(rec.seq == 3 && rec.args[0] == 2 && rec.ts_ms == 1002 && rec.nargs == 1);
+
+    // 模擬寫入端正在寫序號 3 (槽位 seq 已清 0)
+    r.head = 4;
+    s_slots[3].seq = 0;
+    CHECK(dlog_ring_read(&r, 3, &rec) == DLOG_READ_PENDING);
+
+    // 繞過一圈：序號 8 覆寫了序號 0 的槽位
+    dlog_ring_init(&r, s_slots, SLOTS);
+    put_n(&r, SLOTS + 1);
+    CHECK(dlog_ring_read(&r, 0, &rec) == DLOG_READ_LOST);
+    CHECK(dlog_ring_read(&r, 8, &rec) == DLOG_READ_OK);
+    CHECK(dlog_ring_read(&r, 9, &rec) == DLOG_READ_PENDING); // 槽位裡仍是上一圈的序號 1 = 寫入端尚未到達
+    CHECK(dlog_ring_oldest(&r) == 1);
+}
+
+// drain：依序取出、遇到寫入中就停、落後一整圈以上時跳到最舊並回報遺失
+static void test_drain(void) {
+    dlog_ring_t r;
+    dlog_ring_init(&r, s_slots, SLOTS);
+
+    uint32_t cursor = 0;
+    collect_t c = {0};
+    put_n(&r, 5);
+    CHECK(dlog_ring_drain(&r, &cursor, collect, &c) == 0);
+    CHECK(c.count == 5 && cursor == 5);
+    CHECK(c.seen[0] == 0 && c.seen[4] == 4);
+
+    // 序號 6 寫入中：取到 5 為止，cursor 停在 6
+    put_n(&r, 2);
+    s_slots[6 & (SLOTS - 1)].seq = 0;
+    memset(&c, 0, sizeof(c));
+    CHECK(dlog_ring_drain(&r, &cursor, collect, &c) == 0);
+    CHECK(c.count == 1 && c.seen[0] == 5 && cursor == 6);
+    s_slots[6 & (SLOTS - 1)].seq = 7; // 寫入完成
+    memset(&c, 0, sizeof(c));
+    CHECK(dlog_ring_drain(&r, &cursor, collect, &c) == 0);
+    CHECK(c.count == 1 && c.seen[0] == 6 && cursor == 7);
+
+    // 讀取端落後：再寫 20 筆 (head = 27)，只剩 19..26
+    put_n(&r, 20);
+    memset(&c, 0, sizeof(c));
+    CHECK(dlog_ring_drain(&r, &cursor, collect, &c) == 27 - SLOTS - 7);
+    CHECK(c.count == SLOTS && c.seen[0] == 19 && c.seen[SLOTS - 1] == 26);
+    CHECK(cursor == 27);
+
+    // 圈內的單筆覆寫 (讀取中被寫入端追上) 計入遺失但不中斷
+    put_n(&r, 3);                                // 27..29
+    s_slots[28 & (SLOTS - 1)].seq = 28 + SLOTS + 1; // 假裝 28 已被下一圈覆寫
+    memset(&c, 0, sizeof(c));
+    CHECK(dlog_ring_drain(&r, &cursor, collect, &c) == 1);
+    CHECK(c.count == 2 && c.seen[0] == 27 && c.seen[1] == 29);
+}
+
+// 把 ring 匯出成 /log/raw 相同格式的記憶體區塊
+static size_t make_dump(const dlog_ring_t *r, unsigned char *buf, size_t cap) {
+    dlog_dump_hdr_t hdr;
+    dlog_dump_header(r, &hdr);
+    size_t len = sizeof(hdr) + hdr.slot_count * sizeof(dlog_record_t);
+    if (len > cap) return 0;
+    memcpy(buf, &hdr, sizeof(hdr));
+    dlog_dump_records(r, hdr.head - hdr.slot_count, (dlog_record_t *)(buf + sizeof(hdr)), hdr.slot_count);
+    return len;
+}
+
+// 解碼成文字 (寫到暫存檔再讀回)
+static uint32_t decode_to_text(const unsigned char *buf, char *text, size_t cap) {
+    dlog_dump_hdr_t hdr;
+    memcpy(&hdr, buf, sizeof(hdr));
+    FILE *f = tmpfile();
+    CHECK(f != NULL);
+    if (!f) return 0;
+    uint32_t lost = dlog_dump_decode(&hdr, (const dlog_record_t *)(buf + sizeof(hdr)), f);
+    rewind(f);
+    size_t n = fread(text, 1, cap - 1, f);
+    text[n] = '\0';
+    fclose(f);
+    return lost;
+}
+
+// 匯出 -> 驗證 -> 解碼 來回，包含 0 填充 (寫入中) 與序號不符 (已覆寫) 的槽位
+static void test_dump_round_trip(void) {
+    static unsigned char buf[sizeof(dlog_dump_hdr_t) + SLOTS * sizeof(dlog_record_t)];
+    static char text[4096];
+    dlog_ring_t r;
+    dlog_ring_init(&r, s_slots, SLOTS);
+
+    // 空的 ring：只有檔頭
+    size_t len = make_dump(&r, buf, sizeof(buf));
+    CHECK(len == sizeof(dlog_dump_hdr_t));
+    CHECK(dlog_dump_check((const dlog_dump_hdr_t *)buf, len) == NULL);
+    CHECK(decode_to_text(buf, text, sizeof(text)) == 0);
+    CHECK(text[0] == '\0');
+
+    // 寫 11 筆 (序號 0..10，保留 3..10)，序號 5 寫入中
+    put_n(&r, 11);
+    s_slots[5 & (SLOTS - 1)].seq = 0;
+    len = make_dump(&r, buf, sizeof(buf));
+    const dlog_dump_hdr_t *hdr = (const dlog_dump_hdr_t *)buf;
+    CHECK(hdr->magic == DLOG_DUMP_MAGIC && hdr->version == DLOG_DUMP_VERSION);
+    CHECK(hdr->head == 11 && hdr->slot_count == SLOTS);
+    CHECK(len == sizeof(*hdr) + SLOTS * sizeof(dlog_record_t));
+    CHECK(dlog_dump_check(hdr, len) == NULL);
+
+    // 匯出檔中的第 5 筆 (序號 8) 改成下一圈的序號，模擬匯出後才被發現的覆寫
+    dlog_record_t *recs = (dlog_record_t *)(buf + sizeof(*hdr));
+    recs[5].seq = 8 + SLOTS + 1;
+
+    CHECK(decode_to_text(buf, text, sizeof(text)) == 2);
+    CHECK(strstr(text, "... 3 earlier records overwritten\n") == text);
+    CHECK(strstr(text, "D (1003) DLOG: bench 3\nD (1004) DLOG: bench 4\n... 1 records lost\n"
+                       "D (1006) DLOG: bench 6\nD (1007) DLOG: bench 7\n... 1 records lost\n"
+                       "D (1009) DLOG: bench 9\nD (1010) DLOG: bench 10\n") != NULL);
+}
+
+// 檔頭與檔案大小不一致時拒絕 (不可依檔頭的原始數值配置記憶體)
+static void test_dump_check_rejects(void) {
+    dlog_dump_hdr_t hdr;
+    dlog_ring_t r;
+    dlog_ring_init(&r, s_slots, SLOTS);
+    put_n(&r, 4);
+    dlog_dump_header(&r, &hdr);
+    size_t ok_len = sizeof(hdr) + 4 * sizeof(dlog_record_t);
+    CHECK(dlog_dump_check(&hdr, ok_len) == NULL);
+
+    CHECK(dlog_dump_check(&hdr, ok_len - 1) != NULL);                    // 截斷
+    CHECK(dlog_dump_check(&hdr, ok_len + sizeof(dlog_record_t)) != NULL); // 多出資料
+    CHECK(dlog_dump_check(&hdr, sizeof(hdr) - 1) != NULL);               // 連檔頭都不完整
+
+    dlog_dump_hdr_t bad = hdr;
+    bad.slot_count = 0xFFFFFFF0u;
+    bad.head = 0xFFFFFFF0u;
+    CHECK(dlog_dump_check(&bad, ok_len) != NULL);
+    bad = hdr;
+    bad.slot_count = 5; // 大於 head
+    CHECK(dlog_dump_check(&bad, sizeof(hdr) + 5 * sizeof(dlog_record_t)) != NULL);
+    bad = hdr;
+    bad.magic ^= 1;
+    CHECK(dlog_dump_check(&bad, ok_len) != NULL);
+    bad = hdr;
+    bad.record_size = 16;
+    CHECK(dlog_dump_check(&bad, ok_len) != NULL);
+}
+
+int main(void) {
+    test_read_classification();
+    test_drain();
+    test_dump_round_trip();
+    test_dump_check_rejects();
+
+    return check_report("dlog_ring");
+}
@@ -0,0 +1,128 @@
+/*
+ * 閒置電源策略 (main/power_policy.c) 主機端測試
+ * 以模擬時間驅動狀態機，不需要硬體。
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "power_policy.h"
+#include "ctrl_logic.h"
+#include "check.h"
+
+static power_policy_cfg_t test_cfg(void) {
+    power_policy_cfg_t cfg = {
+        .idle_timeout_ms = 1000,
+        .active_poll_ms = 200,
+        .idle_poll_ms = 5000,
+        .wake_budget_us = 20000,
+    };
+    return cfg;
+}
+
+// 無輸入超過逾時才進入閒置，輪詢週期跟著切換
+static void test_enters_idle_after_timeout(void) {
+    power_policy_cfg_t cfg = test_cfg();
+    power_policy_t p;
+    power_policy_init(&p, &cfg, 0);
+
+    CHECK(p.state == POWER_STATE_ACTIVE);
+    CHECK(power_policy_poll_ms(&p) == 200);
+
+    uint32_t t;
+    for (t = 200; t < 1000; t += 200) {
+        CHECK(!power_policy_update(&p, t, false));
+        CHECK(p.state == POWER_STATE_ACTIVE);
+    }
+    CHECK(power_policy_update(&p, 1000, false));
+    CHECK(p.state == POWER_STATE_IDLE);
+    CHECK(power_policy_poll_ms(&p) == 5000);
+
+    // 已在閒置中，不應重複回報狀態改變
+    CHECK(!power_policy_update(&p, 6000, false));
+    CHECK(p.wake_count == 0);
+}
+
+// 任何活動都會重置逾時；閒置中的活動立即喚醒
+static void test_activity_resets_and_wakes(void) {
+    power_policy_cfg_t cfg = test_cfg();
+    power_policy_t p;
+    power_policy_init(&p, &cfg, 0);
+
+    CHECK(!power_policy_update(&p, 900, true));
+    CHECK(!power_policy_update(&p, 1500, false)); // 距離上次活動只有 600ms
+    CHECK(p.state == POWER_STATE_ACTIVE);
+    CHECK(power_policy_update(&p, 1900, false));
+    CHECK(p.state == POWER_STATE_IDLE);
+
+    CHECK(power_policy_update(&p, 4000, true));
+    CHECK(p.state == POWER_STATE_ACTIVE);
+    CHECK(p.wake_count == 1);
+    CHECK(p.last_activity_ms == 4000);
+}
+
+// 毫秒計數器溢位時仍以差值判斷
+static void test_timer_wraparound(void) {
+    power_policy_cfg_t cfg = test_cfg();
+    power_policy_t p;
+    power_policy_init(&p, &cfg, 0xFFFFFF00u);
+
+    CHECK(!power_policy_update(&p, 0x00000100u, false)); // 經過 512ms
+    CHECK(p.state == POWER_STATE_ACTIVE);
+    CHECK(power_policy_update(&p, 0x00000300u, false));  // 經過 1024ms
+    CHECK(p.state == POWER_STATE_IDLE);
+}
+
+// 喚醒延遲預算統計
+static void test_wake_latency_budget(void) {
+    power_policy_cfg_t cfg = test_cfg();
+    power_policy_t p;
+    power_policy_init(&p, &cfg, 0);
+
+    CHECK(power_policy_record_wake_latency(&p, 3500));
+    CHECK(power_policy_record_wake_latency(&p, 20000));   // 剛好等於預算：合格
+    CHECK(!power_policy_record_wake_latency(&p, 25000));
+    CHECK(power_policy_record_wake_latency(&p, 1200));
+
+    CHECK(p.lat_count == 4);
+    CHECK(p.lat_last_us == 1200);
+    CHECK(p.lat_max_us == 25000);
+    CHECK(p.lat_over_budget == 1);
+}
+
+// 預設設定取自 power_policy.h 的巨集
+static void test_default_cfg(void) {
+    power_policy_t p;
+    power_policy_init(&p, NULL, 0);
+    CHECK(p.cfg.idle_timeout_ms == POWER_IDLE_TIMEOUT_MS);
+    CHECK(p.cfg.active_poll_ms == POWER_ACTIVE_POLL_MS);
+    CHECK(p.cfg.idle_poll_ms == POWER_IDLE_POLL_MS);
+    CHECK(p.cfg.wake_budget_us == POWER_WAKE_BUDGET_US);
+}
+
+// 活動判定：只看輸入腳位，燈號與電位器變化不算
+static void test_inputs_changed(void) {
+    io_snapshot_t a, b;
+    ctrl_snapshot_decode(1ULL << A1_1_GPIO, 100, 200, &a);
+
+    b = a;
+    b.a2 = 1;
+    b.b2_pot = 4000;
+    CHECK(!ctrl_inputs_changed(&a, &b));
+
+    ctrl_snapshot_decode((1ULL << A1_1_GPIO) | (1ULL << C3_2_GPIO), 100, 200, &b);
+    CHECK(ctrl_inputs_changed(&a, &b));
+
+    ctrl_snapshot_decode((1ULL << A1_1_GPIO) | (1ULL << B5_GPIO), 100, 200, &b);
+    CHECK(ctrl_inputs_changed(&a, &b));
+}
+
+int main(void) {
+    test_enters_idle_after_timeout();
+    test_activity_resets_and_wakes();
+    test_timer_wraparound();
+    test_wake_latency_budget();
+    test_default_cfg();
+    test_inputs_changed();
+
+    return check_report("power_policy");
+}
@@ -0,0 +1,127 @@
+/*
+ * 控制邏輯實作 (純運算，韌體與 host/ 基準測試共用)
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ctrl_logic.h"
+
+// 取出位元圖中某個 GPIO 的電位
+#define LV(levels, gpio) ((uint8_t)(((levels) >> (gpio)) & 1u))
+
+void ctrl_snapshot_decode(uint64_t levels, int b2_pot, int b3_pot, io_snapshot_t *out)
+{
+    out->a1_1 = LV(levels, A1_1_GPIO);
+    out->a1_2 = LV(levels, A1_2_GPIO);
+    out->a2 = LV(levels, A2_GPIO);
+    out->a3 = LV(levels, A3_GPIO);
+    out->a4 = LV(levels, A4_GPIO);
+
+    out->b1_1 = LV(levels, B1_1_GPIO);
+    out->b1_2 = LV(levels, B1_2_GPIO);
+    out->b4 = LV(levels, B4_GPIO);
+    out->b5 = LV(levels, B5_GPIO);
+    out->b2_pot = b2_pot;
+    out->b3_pot = b3_pot;
+
+    out->c1[0] = LV(levels, C1_1_GPIO); out->c1[1] = LV(levels, C1_2_GPIO);
+    out->c1[2] = LV(levels, C1_3_GPIO); out->c1[3] = LV(levels, C1_4_GPIO);
+    out->c2[0] = LV(levels, C2_1_GPIO); out->c2[1] = LV(levels, C2_2_GPIO);
+    out->c2[2] = LV(levels, C2_3_GPIO); out->c2[3] = LV(levels, C2_4_GPIO);
+    out->c3[0] = LV(levels, C3_1_GPIO); out->c3[1] = LV(levels, C3_2_GPIO);
+    out->c3[2] = LV(levels, C3_3_GPIO); out->c3[3] = LV(levels, C3_4_GPIO);
+    out->c4[0] = LV(levels, C4_1_GPIO); out->c4[1] = LV(levels, C4_2_GPIO);
+}
+
+bool ctrl_inputs_changed(const io_snapshot_t *a, const io_snapshot_t *b)
+{
+    return a->a1_1 != b->a1_1 || a->a1_2 != b->a1_2 ||
+           a->b1_1 != b->b1_1 || a->b1_2 != b->b1_2 || a->b4 != b->b4 || a->b5 != b->b5 ||
+           memcmp(a->c1, b->c1, sizeof(a->c1)) != 0 || memcmp(a->c2, b->c2, sizeof(a->c2)) != 0 ||
+           memcmp(a->c3, b->c3, sizeof(a->c3)) != 0 || memcmp(a->c4, b->c4, sizeof(a->c4)) != 0;
+}
+
+ctrl_mode_t ctrl_mode_from_a1(int a1_1, int a1_2)
+{
+    // 邏輯表 (依據硬體設計)：兩者皆高 -> 自動；僅 A1_1 -> 手動；僅 A1_2 -> 搖桿
+    if (a1_1 && a1_2) return CTRL_MODE_AUTO;
+    if (a1_1) return CTRL_MODE_MANUAL;
+    if (a1_2) return CTRL_MODE_JOYSTICK;
+    return CTRL_MODE_OFF;
+}
+
+uint8_t ctrl_mode_lamps(ctrl_mode_t mode)
+{
+    switch (mode) {
+    case CTRL_MODE_AUTO:     return CTRL_LAMP_A2;
+    case CTRL_MODE_MANUAL:   return CTRL_LAMP_A3;
+    case CTRL_MODE_JOYSTICK: return CTRL_LAMP_A4;
+    default:                 return 0;
+    }
+}
+
+void ctrl_select(const io_snapshot_t *s, ctrl_select_t *out)
+{
+    // 切換開關 B4 決定讀取哪個電位器
+    out->src = s->b4 ? 3 : 2;
+    // 三檔位開關 B1 決定儲存目標索引 (0, 1, 2)
+    out->idx = (s->b1_1 == 0 && s->b1_2 == 0) ? 0 :
+               (s->b1_1 == 0 && s->b1_2 == 1) ? 1 : 2;
+    // 點動開關 B5 按下時 -> 儲存
+    out->store = s->b5 != 0;
+}
+
+int ctrl_status_serialize(const io_snapshot_t *s, char *buf, size_t len)
+{
+    int n = snprintf(buf, len,
+        "{\"A1_1\":%d,\"A1_2\":%d,\"A2\":%d,\"A3\":%d,\"A4\":%d,"
+        "\"B1_1\":%d,\"B1_2\":%d,\"B4\":%d,\"B5\":%d,\"B2_pot\":%d,\"B3_pot\":%d,"
+        "\"C1\":[%d,%d,%d,%d],\"C2\":[%d,%d,%d,%d],\"C3\":[%d,%d,%d,%d],\"C4\":[%d,%d]}",
+        s->a1_1, s->a1_2, s->a2, s->a3, s->a4,
+        s->b1_1, s->b1_2, s->b4, s->b5, s->b2_pot, s->b3_pot,
+        s->c1[0], s->c1[1], s->c1[2], s->c1[3],
+        s->c2[0], s->c2[1], s->c2[2], s->c2[3],
+        s->c3[0], s->c3[1], s->c3[2], s->c3[3],
+        s->c4[0], s->c4[1]);
+    return (n < 0 || (size_t)n >= len) ? -1 : n;
+}
+
+int ctrl_frame_encode(const char *payload, size_t payload_len, char *out, size_t cap)
+{
+    if (payload_len + 1 > cap) return -1;
+    memcpy(out, payload, payload_len);
+    out[payload_len] = '\n'; // 補上換行符號 (Jetson 端以行為單位解析)
+    return (int)payload_len + 1;
+}
+
+void ctrl_frame_decoder_init(ctrl_frame_decoder_t *d)
+{
+    d->len = 0;
+    d->overflow = false;
+}
+
+size_t ctrl_frame_decode(ctrl_frame_decoder_t *d, const uint8_t *data, size_t len,
+                         const char **line, size_t *line_len)
+{
+    *line = NULL;
+    *line_len = 0;
+
+    const uint8_t *nl = memchr(data, '\n', len);
+    size_t chunk = nl ? (size_t)(nl - data) : len;
+
+    // 超長的行：丟棄到下一個換行為止
+    if (!d->overflow && d->len + chunk > sizeof(d->buf)) d->overflow = true;
+    if (!d->overflow) {
+        memcpy(d->buf + d->len, data, chunk);
+        d->len += chunk;
+    }
+    if (!nl) return len;
+
+    if (!d->overflow) {
+        *line = d->buf;
+        *line_len = d->len;
+    }
+    d->len = 0;
+    d->overflow = false;
+    return chunk + 1;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+/*
+ * 控制邏輯 (純運算，不呼叫任何 ESP-IDF 驅動)
+ * 韌體 (main.c) 與主機端基準測試 (host/) 共用同一份原始碼：
+ *   GPIO 電位快照解碼 -> 模式/燈號 -> B1/B4/B5 選擇邏輯 -> /status JSON -> UART 封包
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "io_config.h" // 腳位定義 (解碼快照用)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// /status JSON 最大長度與 UART 封包 (JSON + '\n') 最大長度
+#define CTRL_STATUS_MAX 512
+#define CTRL_FRAME_MAX  (CTRL_STATUS_MAX + 1)
+
+// --- 一次讀取的所有輸入/輸出電位 (0 = Low, 1 = High) ---
+typedef struct {
+    uint8_t a1_1, a1_2, a2, a3, a4;
+    uint8_t b1_1, b1_2, b4, b5;
+    int b2_pot, b3_pot;             // ADC 原始值 (0~4095)
+    uint8_t c1[4], c2[4], c3[4], c4[2];
+} io_snapshot_t;
+
+// --- 操作模式 (由 A1 三檔位開關決定) ---
+typedef enum {
+    CTRL_MODE_OFF = 0,              // 全滅
+    CTRL_MODE_AUTO,                 // A2 亮
+    CTRL_MODE_MANUAL,               // A3 亮
+    CTRL_MODE_JOYSTICK,             // A4 亮
+} ctrl_mode_t;
+
+// 指示燈輸出位元
+#define CTRL_LAMP_A2 (1u << 0)
+#define CTRL_LAMP_A3 (1u << 1)
+#define CTRL_LAMP_A4 (1u << 2)
+
+// --- 選擇端 (B 系列) 判斷結果 ---
+typedef struct {
+    int idx;                        // B1 決定的儲存目標 (0, 1, 2)
+    int src;                        // B4 決定的電位器 (2 = B2, 3 = B3)
+    bool store;                     // B5 按下 -> 儲存並鳴叫
+} ctrl_select_t;
+
+// 由 GPIO 電位位元圖 (bit n = GPIO n) 解碼成快照；電位器數值由呼叫端另外提供
+void ctrl_snapshot_decode(uint64_t levels, int b2_pot, int b3_pot, io_snapshot_t *out);
+
+// 比較兩份快照的「輸入」腳位 (A1/B1/B4/B5/C 系列) 是否不同；輸出燈號與電位器不列入
+bool ctrl_inputs_changed(const io_snapshot_t *a, const io_snapshot_t *b);
+
+// A1 開關 -> 模式
+ctrl_mode_t ctrl_mode_from_a1(int a1_1, int a1_2);
+
+// 模式 -> 指示燈輸出 (CTRL_LAMP_* 組合)
+uint8_t ctrl_mode_lamps(ctrl_mode_t mode);
+
+// B1/B4/B5 -> 選擇結果 (僅在手動模式下有意義)
+void ctrl_select(const io_snapshot_t *s, ctrl_select_t *out);
+
+// 快照 -> /status JSON；回傳字串長度，緩衝區不足回傳 -1
+int ctrl_status_serialize(const io_snapshot_t *s, char *buf, size_t len);
+
+// --- UART 封包 (以 '\n' 分隔的 JSON 行) ---
+
+// 將 payload 加上換行組成一個封包；回傳封包長度，緩衝區不足回傳 -1
+int ctrl_frame_encode(const char *payload, size_t payload_len, char *out, size_t cap);
+
+// 逐段接收並切出完整封包 (超過 CTRL_FRAME_MAX 的行會整行丟棄)
+typedef struct {
+    char buf[CTRL_FRAME_MAX];
+    size_t len;
+    bool overflow;
+} ctrl_frame_decoder_t;
+
+void ctrl_frame_decoder_init(ctrl_frame_decoder_t *d);
+
+// 餵入 data；遇到完整一行時 *line / *line_len 指向內容 (不含 '\n'，在下次呼叫前有效) 並立刻返回
+// 回傳本次消耗的位元組數 (呼叫端應以剩餘資料繼續呼叫)；*line 為 NULL 表示尚無完整封包
+size_t ctrl_frame_decode(ctrl_frame_decoder_t *d, const uint8_t *data, size_t len,
+                         const char **line, size_t *line_len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,130 @@
+/*
+ * 延遲式二進位日誌 (Deferred Log) 實作
+ * 環形緩衝區本身 (無鎖寫入、seqlock 讀取、匯出格式) 在 dlog_ring.c；
+ * 本檔負責配置 PSRAM、填入時間戳/核心編號，並將讀取結果轉成 esp_err_t。
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include "dlog.h"
+
+static const char *TAG = "DLOG";
+
+_Static_assert((DLOG_SLOTS & (DLOG_SLOTS - 1)) == 0, "DLOG_SLOTS must be a power of 2");
+_Static_assert((DLOG_BENCH_SLOTS & (DLOG_BENCH_SLOTS - 1)) == 0, "DLOG_BENCH_SLOTS must be a power of 2");
+_Static_assert(sizeof(dlog_record_t) == 32, "dlog_record_t must stay 32 bytes");
+
+static dlog_ring_t s_ring; // 槽位在 PSRAM；本結構 (含 head) 在內部 RAM
+
+esp_err_t dlog_init(void)
+{
+    if (s_ring.slots) return ESP_OK;
+    dlog_record_t *slots = heap_caps_malloc(DLOG_SLOTS * sizeof(dlog_record_t), MALLOC_CAP_SPIRAM);
+    if (!slots) {
+        // 沒有 PSRAM 時退回內部 RAM
+        ESP_LOGW(TAG, "PSRAM alloc failed, using internal RAM");
+        slots = heap_caps_malloc(DLOG_SLOTS * sizeof(dlog_record_t), MALLOC_CAP_8BIT);
+    }
+    if (!slots) return ESP_ERR_NO_MEM;
+    dlog_ring_init(&s_ring, slots, DLOG_SLOTS);
+    ESP_LOGI(TAG, "Ring ready: %d slots (%d bytes)", DLOG_SLOTS, (int)(DLOG_SLOTS * sizeof(dlog_record_t)));
+    return ESP_OK;
+}
+
+// 寫入一筆 (正式環與基準測試用的暫存環共用同一段寫入路徑)
+static inline dlog_record_t *ring_put(dlog_ring_t *ring, uint16_t id, uint8_t nargs,
+                                      int32_t a0, int32_t a1, int32_t a2, int32_t a3)
+{
+    return dlog_ring_put(ring, (uint32_t)(esp_timer_get_time() / 1000), (uint8_t)esp_cpu_get_core_id(),
+                         id, nargs, a0, a1, a2, a3);
+}
+
+void dlog_write(uint16_t id, uint8_t nargs, int32_t a0, int32_t a1, int32_t a2, int32_t a3)
+{
+    if (!s_ring.slots) return;
+    dlog_record_t *r = ring_put(&s_ring, id, nargs, a0, a1, a2, a3);
+    (void)r; // 僅 DLOG_ECHO_CONSOLE 使用
+
+#if DLOG_ECHO_CONSOLE
+    char line[128];
+    dlog_format_record(r, line, sizeof(line));
+    esp_rom_printf("%s\n", line);
+#endif
+}
+
+uint32_t dlog_head(void)
+{
+    return dlog_ring_head(&s_ring);
+}
+
+uint32_t dlog_oldest(void)
+{
+    return dlog_ring_oldest(&s_ring);
+}
+
+esp_err_t dlog_read(uint32_t seq, dlog_record_t *out)
+{
+    if (!s_ring.slots) return ESP_ERR_INVALID_STATE;
+    switch (dlog_ring_read(&s_ring, seq, out)) {
+    case DLOG_READ_OK:      return ESP_OK;
+    case DLOG_READ_PENDING: return ESP_ERR_NOT_FINISHED;
+    default:                return ESP_ERR_NOT_FOUND;
+    }
+}
+
+uint32_t dlog_drain(uint32_t *cursor, dlog_sink_t cb, void *ctx)
+{
+    if (!s_ring.slots) return 0;
+    return dlog_ring_drain(&s_ring, cursor, cb, ctx);
+}
+
+void dlog_dump_begin(dlog_dump_hdr_t *hdr)
+{
+    dlog_dump_header(&s_ring, hdr);
+}
+
+void dlog_dump_read(uint32_t seq, dlog_record_t *out, size_t n)
+{
+    if (!s_ring.slots) {
+        memset(out, 0, n * sizeof(*out));
+        return;
+    }
+    dlog_dump_records(&s_ring, seq, out, n);
+}
+
+esp_err_t dlog_benchmark(int iterations, uint32_t *dlog_ns, uint32_t *esp_log_ns, int *esp_log_iters)
+{
+    if (iterations <= 0) iterations = 1;
+
+    // 寫入獨立的暫存環 (同樣放在 PSRAM，耗時與正式環相同)，量測不會覆蓋正式記錄
+    dlog_record_t *slots = heap_caps_malloc(DLOG_BENCH_SLOTS * sizeof(dlog_record_t), MALLOC_CAP_SPIRAM);
+    if (!slots) slots = heap_caps_malloc(DLOG_BENCH_SLOTS * sizeof(dlog_record_t), MALLOC_CAP_8BIT);
+    if (!slots) return ESP_ERR_NO_MEM;
+    dlog_ring_t scratch;
+    dlog_ring_init(&scratch, slots, DLOG_BENCH_SLOTS);
+
+    int64_t t0 = esp_timer_get_time();
+    for (int i = 0; i < iterations; i++) {
+        ring_put(&scratch, DLOG_BENCH, 1, i, 0, 0, 0);
+    }
+    int64_t t1 = esp_timer_get_time();
+    heap_caps_free(slots);
+
+    // ESP_LOGI 會同步送到 Console (115200 baud)，次數上限較小，避免長時間佔住呼叫端
+    int log_iters = (iterations < DLOG_BENCH_ESP_LOG_MAX) ? iterations : DLOG_BENCH_ESP_LOG_MAX;
+    int64_t t2 = esp_timer_get_time();
+    for (int i = 0; i < log_iters; i++) {
+        ESP_LOGI(TAG, "bench %d", i);
+    }
+    int64_t t3 = esp_timer_get_time();
+
+    // 回傳每次呼叫的平均奈秒數
+    if (dlog_ns) *dlog_ns = (uint32_t)((t1 - t0) * 1000 / iterations);
+    if (esp_log_ns) *esp_log_ns = (uint32_t)((t3 - t2) * 1000 / log_iters);
+    if (esp_log_iters) *esp_log_iters = log_iters;
+    return ESP_OK;
+}
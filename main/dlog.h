@@ -0,0 +1,80 @@
+#pragma once
+
+/*
+ * 延遲式二進位日誌 (Deferred Log)
+ * 熱路徑 (WiFi 事件、OTA、狀態迴圈) 只寫入「格式 ID + 整數參數」到 PSRAM 環形緩衝區，
+ * 不做字串格式化、不碰 UART；由低優先權任務在有人觀看時才格式化輸出。
+ *
+ * 使用方式：
+ *   DLOG(WIFI_RETRY, s_retry_num, MAX_RETRY);   // ID 定義在 dlog_fmt.h 的 DLOG_FMT_TABLE
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "dlog_fmt.h"
+#include "dlog_ring.h"   // 環形緩衝區本體 (與 host/ 共用)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 環形緩衝區槽位數 (必須是 2 的次方；1024 筆 x 32 bytes = 32KB，放在 PSRAM)
+#ifndef DLOG_SLOTS
+#define DLOG_SLOTS 1024
+#endif
+
+// 設為 1 時，每筆記錄寫入後同時格式化並以 esp_rom_printf 印到 Console (開發除錯用，會失去延遲的好處)
+#ifndef DLOG_ECHO_CONSOLE
+#define DLOG_ECHO_CONSOLE 0
+#endif
+
+// dlog_benchmark() 使用的暫存環槽位數 (2 的次方；與正式環分開，量測不覆蓋正式記錄)
+#ifndef DLOG_BENCH_SLOTS
+#define DLOG_BENCH_SLOTS 64
+#endif
+
+// dlog_benchmark() 中 ESP_LOGI 的最多呼叫次數 (每次都會同步輸出到 Console)
+#ifndef DLOG_BENCH_ESP_LOG_MAX
+#define DLOG_BENCH_ESP_LOG_MAX 20
+#endif
+
+// 初始化環形緩衝區 (開機時呼叫一次，在任何 DLOG() 之前)
+esp_err_t dlog_init(void);
+
+// 寫入一筆記錄 (無鎖，可在任務或 ISR 中呼叫；多核心同時寫入安全)
+void dlog_write(uint16_t id, uint8_t nargs, int32_t a0, int32_t a1, int32_t a2, int32_t a3);
+
+// 目前的寫入序號 (下一筆記錄會使用的序號)
+uint32_t dlog_head(void);
+
+// 緩衝區內仍保留的最舊序號
+uint32_t dlog_oldest(void);
+
+// 讀取序號 seq 的記錄
+// 回傳 ESP_OK: 成功；ESP_ERR_NOT_FINISHED: 尚在寫入中；ESP_ERR_NOT_FOUND: 已被覆寫
+esp_err_t dlog_read(uint32_t seq, dlog_record_t *out);
+
+// 取出 *cursor 之後已完成的記錄並呼叫 cb，回傳因覆寫而遺失的筆數；*cursor 會前進
+uint32_t dlog_drain(uint32_t *cursor, dlog_sink_t cb, void *ctx);
+
+// 匯出 (/log/raw)：先取檔頭，再從 head - slot_count 起分批讀取 (讀不到的以 0 填充)
+void dlog_dump_begin(dlog_dump_hdr_t *hdr);
+void dlog_dump_read(uint32_t seq, dlog_record_t *out, size_t n);
+
+// 量測每次呼叫的平均耗時 (奈秒)：DLOG() 寫入路徑對比 ESP_LOGI() (後者包含 Console 輸出)
+// DLOG 端寫入暫存環，不影響正式記錄；ESP_LOGI 端最多 DLOG_BENCH_ESP_LOG_MAX 次，實際次數寫入 *esp_log_iters
+esp_err_t dlog_benchmark(int iterations, uint32_t *dlog_ns, uint32_t *esp_log_ns, int *esp_log_iters);
+
+// --- 參數計數與補零巨集 (最多 DLOG_MAX_ARGS 個) ---
+#define DLOG_NARGS_(_0, _1, _2, _3, _4, N, ...) N
+#define DLOG_NARGS(...) DLOG_NARGS_(__VA_ARGS__, 4, 3, 2, 1, 0)
+#define DLOG_ARGS4_(_0, a, b, c, d, ...) (int32_t)(a), (int32_t)(b), (int32_t)(c), (int32_t)(d)
+#define DLOG_ARGS4(...) DLOG_ARGS4_(__VA_ARGS__, 0, 0, 0, 0)
+
+#define DLOG(id, ...) \
+    dlog_write(DLOG_##id, DLOG_NARGS(0, ##__VA_ARGS__), DLOG_ARGS4(0, ##__VA_ARGS__))
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,103 @@
+#pragma once
+
+/*
+ * 延遲式二進位日誌 (Deferred Log) - 共用格式定義
+ * 本檔案不依賴 ESP-IDF，韌體 (dlog.c) 與主機端解碼工具 (tools/dlog_decode.c) 共用，
+ * 確保兩邊對「格式 ID」與「記錄結構」的認知一致。
+ * 新增日誌格式時，只需在 DLOG_FMT_TABLE 尾端追加一行 (請勿插入中間，否則舊的 dump 會解錯)。
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 每筆記錄最多攜帶的整數參數數量
+#define DLOG_MAX_ARGS 4
+
+// --- 格式表 X(ID, 等級字元, 格式字串) ---
+// 參數一律以 int32 儲存，格式字串只能使用 %d / %u / %x 等整數格式 (不可用 %s)
+#define DLOG_FMT_TABLE(X) \
+    X(WIFI_RETRY,  'W', "Retry to connect to the AP (%d/%d)") \
+    X(WIFI_FAIL,   'W', "STA connect failed after %d retries") \
+    X(WIFI_GOT_IP, 'I', "Got IP: %d.%d.%d.%d") \
+    X(OTA_OK,      'I', "OTA Success, Rebooting...") \
+    X(OTA_FAIL,    'E', "OTA Failed (err=0x%x)") \
+    X(MODE_CHANGE, 'I', "Mode change: A1_1=%d A1_2=%d") \
+    X(SEL_STORE,   'I', "B5 stored slot %d = %d (src B%d)") \
+    X(BENCH,       'D', "bench %d") \
+    X(POWER_STATE, 'I', "Power state: idle=%d") \
+    X(WAKE_LATENCY,'I', "Wake latency %d us (budget %d us)") \
+    X(WAKE_OVER_BUDGET, 'W', "Wake latency %d us exceeds budget %d us") \
+    X(UART_RX_LINE,'D', "UART RX line (%d bytes)")
+
+typedef enum {
+#define DLOG_X_ENUM(id, lvl, fmt) DLOG_##id,
+    DLOG_FMT_TABLE(DLOG_X_ENUM)
+#undef DLOG_X_ENUM
+    DLOG_FMT_COUNT
+} dlog_fmt_id_t;
+
+// --- 單筆記錄 (固定 32 bytes，環形緩衝區的一個槽位) ---
+// seq = 寫入序號 + 1；0 代表空槽或正在寫入中 (讀取端用來偵測覆寫/撕裂)
+typedef struct {
+    uint32_t seq;
+    uint32_t ts_ms;                 // 開機後毫秒數 (同 ESP_LOG 時間戳)
+    uint16_t id;                    // dlog_fmt_id_t
+    uint8_t  nargs;
+    uint8_t  core;                  // 寫入時所在的 CPU 核心
+    int32_t  args[DLOG_MAX_ARGS];
+    uint32_t reserved;
+} dlog_record_t;
+
+// --- /log/raw 匯出檔的檔頭 (之後緊接 slot_count 筆 dlog_record_t，小端序) ---
+#define DLOG_DUMP_MAGIC   0x31474C44u // "DLG1"
+#define DLOG_DUMP_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;           // sizeof(dlog_record_t)
+    uint32_t slot_count;
+    uint32_t head;                  // 下一個要寫入的序號
+} dlog_dump_hdr_t;
+
+// 取得格式字串 (未知 ID 回傳 NULL)
+static inline const char *dlog_fmt_str(uint16_t id) {
+    static const char *const fmts[] = {
+#define DLOG_X_FMT(id, lvl, fmt) fmt,
+        DLOG_FMT_TABLE(DLOG_X_FMT)
+#undef DLOG_X_FMT
+    };
+    return (id < DLOG_FMT_COUNT) ? fmts[id] : NULL;
+}
+
+// 取得等級字元 (E/W/I/D)
+static inline char dlog_level_char(uint16_t id) {
+    static const char lvls[] = {
+#define DLOG_X_LVL(id, lvl, fmt) lvl,
+        DLOG_FMT_TABLE(DLOG_X_LVL)
+#undef DLOG_X_LVL
+    };
+    return (id < DLOG_FMT_COUNT) ? lvls[id] : '?';
+}
+
+// 將一筆記錄格式化成文字 (格式與 ESP_LOG 相同："I (1234) DLOG: ...")
+// 回傳寫入的字元數 (不含結尾 0，已截斷至 len-1)
+static inline int dlog_format_record(const dlog_record_t *r, char *out, size_t len) {
+    if (len == 0) return 0;
+    const char *fmt = dlog_fmt_str(r->id);
+    int n = snprintf(out, len, "%c (%lu) DLOG: ", dlog_level_char(r->id), (unsigned long)r->ts_ms);
+    if (n < 0 || (size_t)n >= len) return (int)len - 1;
+    int m = fmt ? snprintf(out + n, len - n, fmt, r->args[0], r->args[1], r->args[2], r->args[3])
+                : snprintf(out + n, len - n, "<unknown id %u>", (unsigned)r->id);
+    if (m < 0) return n;
+    return ((size_t)(n + m) >= len) ? (int)len - 1 : n + m;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,149 @@
+/*
+ * 延遲式日誌環形緩衝區實作 (純運算，韌體、解碼工具與 host/ 測試共用)
+ *
+ * - 寫入端：原子遞增 head 取得序號 -> 槽位 seq 清 0 -> 填資料 -> seq = 序號+1 (release)。
+ *   多個寫入端 (雙核心 / ISR) 各自拿到不同序號，不需要鎖。
+ * - 讀取端：類似 seqlock，複製前後各讀一次 seq，不一致代表被覆寫，丟棄該筆。
+ * - 緩衝區滿時直接覆蓋最舊記錄，寫入端永遠不會阻塞。
+ */
+
+#include <string.h>
+#include "dlog_ring.h"
+
+void dlog_ring_init(dlog_ring_t *r, dlog_record_t *slots, uint32_t count)
+{
+    memset(slots, 0, count * sizeof(dlog_record_t));
+    r->slots = slots;
+    r->mask = count - 1;
+    r->head = 0;
+}
+
+dlog_record_t *dlog_ring_put(dlog_ring_t *r, uint32_t ts_ms, uint8_t core,
+                             uint16_t id, uint8_t nargs, int32_t a0, int32_t a1, int32_t a2, int32_t a3)
+{
+    uint32_t seq = __atomic_fetch_add(&r->head, 1, __ATOMIC_RELAXED);
+    dlog_record_t *rec = &r->slots[seq & r->mask];
+
+    // 先標記「寫入中」，讓讀取端不會讀到半筆資料
+    __atomic_store_n(&rec->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    rec->ts_ms = ts_ms;
+    rec->id = id;
+    rec->nargs = nargs;
+    rec->core = core;
+    rec->args[0] = a0;
+    rec->args[1] = a1;
+    rec->args[2] = a2;
+    rec->args[3] = a3;
+
+    __atomic_store_n(&rec->seq, seq + 1, __ATOMIC_RELEASE);
+    return rec;
+}
+
+uint32_t dlog_ring_head(const dlog_ring_t *r)
+{
+    return __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+}
+
+uint32_t dlog_ring_oldest(const dlog_ring_t *r)
+{
+    uint32_t head = dlog_ring_head(r);
+    return (head > r->mask + 1) ? head - (r->mask + 1) : 0;
+}
+
+dlog_read_t dlog_ring_read(const dlog_ring_t *r, uint32_t seq, dlog_record_t *out)
+{
+    const dlog_record_t *slot = &r->slots[seq & r->mask];
+
+    uint32_t s1 = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if (s1 != seq + 1) {
+        // 槽位序號落後 (或為 0) = 寫入端尚未完成；超前 = 已被新資料覆寫
+        return (s1 == 0 || (int32_t)(s1 - (seq + 1)) < 0) ? DLOG_READ_PENDING : DLOG_READ_LOST;
+    }
+    memcpy(out, slot, sizeof(*out));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint32_t s2 = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+    return (s2 == s1) ? DLOG_READ_OK : DLOG_READ_LOST;
+}
+
+uint32_t dlog_ring_drain(const dlog_ring_t *r, uint32_t *cursor, dlog_sink_t cb, void *ctx)
+{
+    uint32_t head = dlog_ring_head(r);
+    uint32_t slots = r->mask + 1;
+    uint32_t lost = 0;
+
+    // 讀取端落後超過一整圈：跳到仍保留的最舊記錄
+    if ((int32_t)(head - *cursor) > (int32_t)slots) {
+        lost = head - slots - *cursor;
+        *cursor = head - slots;
+    }
+
+    dlog_record_t rec;
+    while (*cursor != head) {
+        dlog_read_t res = dlog_ring_read(r, *cursor, &rec);
+        if (res == DLOG_READ_PENDING) break; // 下次再來
+        if (res == DLOG_READ_OK) cb(&rec, ctx);
+        else lost++;
+        (*cursor)++;
+    }
+    return lost;
+}
+
+void dlog_dump_header(const dlog_ring_t *r, dlog_dump_hdr_t *hdr)
+{
+    uint32_t head = dlog_ring_head(r);
+    uint32_t slots = r->mask + 1;
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->magic = DLOG_DUMP_MAGIC;
+    hdr->version = DLOG_DUMP_VERSION;
+    hdr->record_size = sizeof(dlog_record_t);
+    hdr->head = head;
+    hdr->slot_count = (head > slots) ? slots : head;
+}
+
+void dlog_dump_records(const dlog_ring_t *r, uint32_t seq, dlog_record_t *out, size_t n)
+{
+    for (size_t i = 0; i < n; i++, seq++) {
+        if (dlog_ring_read(r, seq, &out[i]) != DLOG_READ_OK) memset(&out[i], 0, sizeof(out[i]));
+    }
+}
+
+const char *dlog_dump_check(const dlog_dump_hdr_t *hdr, size_t file_len)
+{
+    if (file_len < sizeof(*hdr) || hdr->magic != DLOG_DUMP_MAGIC) return "not a dlog dump";
+    if (hdr->version != DLOG_DUMP_VERSION || hdr->record_size != sizeof(dlog_record_t)) return "unsupported dump version or record size";
+    if (hdr->slot_count > hdr->head) return "slot_count exceeds head";
+    // 以除法比較，避免 slot_count 很大時乘法溢位
+    size_t body = file_len - sizeof(*hdr);
+    if (body % sizeof(dlog_record_t) != 0 || body / sizeof(dlog_record_t) != hdr->slot_count) return "slot_count does not match file size";
+    return NULL;
+}
+
+static void print_lost(FILE *out, uint32_t n)
+{
+    if (n > 0) fprintf(out, "... %lu records lost\n", (unsigned long)n);
+}
+
+uint32_t dlog_dump_decode(const dlog_dump_hdr_t *hdr, const dlog_record_t *recs, FILE *out)
+{
+    uint32_t first = hdr->head - hdr->slot_count;
+    if (first > 0) fprintf(out, "... %lu earlier records overwritten\n", (unsigned long)first);
+
+    // 匯出時讀不到的槽位為 0；序號對不上的也視為遺失 (連續的遺失合併成一行)
+    char line[256];
+    uint32_t lost = 0, run = 0;
+    for (uint32_t i = 0; i < hdr->slot_count; i++) {
+        if (recs[i].seq != first + i + 1) {
+            run++;
+            continue;
+        }
+        print_lost(out, run);
+        lost += run;
+        run = 0;
+        dlog_format_record(&recs[i], line, sizeof(line));
+        fprintf(out, "%s\n", line);
+    }
+    print_lost(out, run);
+    return lost + run;
+}
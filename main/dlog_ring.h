@@ -0,0 +1,71 @@
+#pragma once
+
+/*
+ * 延遲式日誌 (Deferred Log) - 環形緩衝區與匯出檔 (純運算，不依賴 ESP-IDF)
+ * 韌體 (dlog.c)、主機端解碼工具 (tools/dlog_decode.c) 與 host/ 測試共用：
+ *   寫入 (dlog_ring_put) -> 讀取/追趕 (dlog_ring_read / dlog_ring_drain) -> 匯出 (dlog_dump_*) -> 解碼
+ *
+ * 時間戳與核心編號由呼叫端提供，本模組只負責槽位與序號。
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "dlog_fmt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 環形緩衝區：slots 可以放在 PSRAM，但本結構 (head) 必須在內部 RAM
+// (ESP32-S3 的原子 read-modify-write 指令不能作用在 PSRAM 上)
+typedef struct {
+    dlog_record_t *slots;
+    uint32_t mask;      // 槽位數 - 1 (槽位數必須是 2 的次方)
+    uint32_t head;      // 下一個寫入序號 (原子操作)
+} dlog_ring_t;
+
+// 單筆讀取結果
+typedef enum {
+    DLOG_READ_OK = 0,
+    DLOG_READ_PENDING,  // 寫入端尚未完成 (稍後再讀)
+    DLOG_READ_LOST,     // 已被新資料覆寫
+} dlog_read_t;
+
+typedef void (*dlog_sink_t)(const dlog_record_t *rec, void *ctx);
+
+// 綁定槽位陣列並清空 (count 必須是 2 的次方)
+void dlog_ring_init(dlog_ring_t *r, dlog_record_t *slots, uint32_t count);
+
+// 寫入一筆 (無鎖，多個寫入端同時呼叫安全)；回傳寫入的槽位
+dlog_record_t *dlog_ring_put(dlog_ring_t *r, uint32_t ts_ms, uint8_t core,
+                             uint16_t id, uint8_t nargs, int32_t a0, int32_t a1, int32_t a2, int32_t a3);
+
+// 目前的寫入序號 / 仍保留的最舊序號
+uint32_t dlog_ring_head(const dlog_ring_t *r);
+uint32_t dlog_ring_oldest(const dlog_ring_t *r);
+
+// 讀取序號 seq 的記錄 (seqlock：複製前後 seq 不一致視為已覆寫)
+dlog_read_t dlog_ring_read(const dlog_ring_t *r, uint32_t seq, dlog_record_t *out);
+
+// 取出 *cursor 之後已完成的記錄並呼叫 cb，回傳因覆寫而遺失的筆數；*cursor 會前進
+// 落後超過一整圈時直接跳到最舊的記錄；遇到寫入中的記錄就停下 (下次再從該筆繼續)
+uint32_t dlog_ring_drain(const dlog_ring_t *r, uint32_t *cursor, dlog_sink_t cb, void *ctx);
+
+// --- 匯出檔 (/log/raw)：dlog_dump_hdr_t + slot_count 筆記錄，第 i 筆為序號 (head - slot_count + i) ---
+
+// 以目前的 head 填好檔頭 (slot_count = 仍保留的筆數)
+void dlog_dump_header(const dlog_ring_t *r, dlog_dump_hdr_t *hdr);
+
+// 複製序號 seq 起的 n 筆記錄；讀不到的 (寫入中/已覆寫) 以 0 填充
+void dlog_dump_records(const dlog_ring_t *r, uint32_t seq, dlog_record_t *out, size_t n);
+
+// 檢查檔頭與檔案大小是否一致 (file_len 含檔頭)；合法回傳 NULL，否則回傳錯誤說明
+const char *dlog_dump_check(const dlog_dump_hdr_t *hdr, size_t file_len);
+
+// 將已通過 dlog_dump_check 的記錄解碼成文字寫到 out；回傳遺失 (0 填充或序號不符) 的筆數
+uint32_t dlog_dump_decode(const dlog_dump_hdr_t *hdr, const dlog_record_t *recs, FILE *out);
+
+#ifdef __cplusplus
+}
+#endif
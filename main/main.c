@@ -6,6 +6,8 @@
  * 3. SPIFFS: 存放 index.html 網頁檔。
  * 4. Web Server: 提供網頁監控、OTA 更新、WiFi 設定修改。
  * 5. IO/UART: 讀取搖桿/開關狀態，透過 UART 傳送 JSON 給 Jetson Orin Nano。
+ * 6. DLOG: 熱路徑日誌寫入 PSRAM 環形緩衝區，透過 /log 與 WebSocket /ws/log 查看。
+ * 7. 電源管理: 閒置時 DFS 降頻 + 自動 light sleep，由 GPIO 邊緣或 UART 接收喚醒。
  */
 
 #include <stdio.h>
@@ -15,6 +17,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
+#include "freertos/queue.h"
 #include "esp_system.h"
 #include "esp_log.h"
 #include "esp_err.h"
@@ -25,6 +28,8 @@
 #include "esp_http_client.h"
 #include "esp_https_ota.h"
 #include "io_config.h" // 包含所有 GPIO 腳位定義
+#include "ctrl_logic.h" // 快照解碼、選擇邏輯、/status 序列化、UART 封包 (與 host/ 共用)
+#include "soc/gpio_reg.h"  // GPIO_IN_REG / GPIO_IN1_REG (一次讀取所有輸入)
 #include "nvs_flash.h"
 #include "nvs.h"
 #include "esp_netif.h"
@@ -33,6 +38,11 @@
 #include "esp_spiffs.h"
 #include "cJSON.h"     // 用於解析與產生 JSON 資料
 #include "esp_crt_bundle.h" // 用於 HTTPS OTA 的憑證驗證
+#include "esp_pm.h"          // 動態調頻 (DFS) 與 PM lock
+#include "esp_sleep.h"       // light sleep 喚醒來源
+#include "esp_timer.h"
+#include "dlog.h"            // 延遲式二進位日誌 (熱路徑用)
+#include "power_policy.h"    // 閒置判斷與喚醒延遲預算 (與 host/ 共用)
 
 // --- Log 標籤 ---
 static const char *TAG = "CONTROLLER";
@@ -55,6 +65,11 @@ static EventGroupHandle_t s_wifi_event_group;
 #define WIFI_FAIL_BIT      BIT1 // 連線失敗旗標
 static int s_retry_num = 0;     // 目前重試次數計數器
 
+// --- 狀態任務通知旗標 (由 GPIO ISR / UART 接收任務喚醒 status_task) ---
+static TaskHandle_t s_status_task = NULL;
+#define STATUS_EVT_GPIO BIT0 // 輸入腳位電位改變
+#define STATUS_EVT_UART BIT1 // Jetson 端有資料傳入
+
 // --- 系統設定結構體 (用於暫存 NVS 讀出的資料) ---
 typedef struct {
     char wifi_ssid[32];
@@ -133,15 +148,16 @@ static void event_handler(void* arg, esp_event_base_t event_base,
         if (s_retry_num < MAX_RETRY) {
             esp_wifi_connect();
             s_retry_num++;
-            ESP_LOGW(TAG, "Retry to connect to the AP (%d/%d)", s_retry_num, MAX_RETRY);
+            DLOG(WIFI_RETRY, s_retry_num, MAX_RETRY);
         } else {
             // 超過次數，設定「失敗旗標」，準備切換到 AP 模式
+            DLOG(WIFI_FAIL, MAX_RETRY);
             xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
         }
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         // 成功取得 IP
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
-        ESP_LOGI(TAG, "Got IP: " IPSTR, IP2STR(&event->ip_info.ip));
+        DLOG(WIFI_GOT_IP, IP2STR(&event->ip_info.ip));
         s_retry_num = 0;
         xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
     }
@@ -187,6 +203,9 @@ bool wifi_init_sta(void)
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
     ESP_ERROR_CHECK(esp_wifi_start());
 
+    // Modem sleep：射頻只在 DTIM beacon 醒來，light sleep 期間網頁仍可連線
+    esp_wifi_set_ps(WIFI_PS_MIN_MODEM);
+
     ESP_LOGI(TAG, "Connecting to SSID: %s", sys_cfg.wifi_ssid);
 
     // 等待連線結果 (阻塞直到成功或失敗)
@@ -255,6 +274,8 @@ void io_init(void)
 int io_read_pin(gpio_num_t pin) { return gpio_get_level(pin); }
 void io_write_pin(gpio_num_t pin, int level) { gpio_set_level(pin, level); }
 
+static QueueHandle_t s_uart_queue = NULL; // UART 驅動事件佇列
+
 // 初始化 UART (連接 Jetson Orin Nano)
 void comms_uart_init(void) {
     uart_config_t uart_config = {
@@ -262,18 +283,53 @@ void comms_uart_init(void) {
         .data_bits = UART_DATA_8_BITS,
         .parity    = UART_PARITY_DISABLE,
         .stop_bits = UART_STOP_BITS_1,
-        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_XTAL // 不受 DFS 降頻影響，且 light sleep 喚醒需要
     };
     uart_param_config(JETSON_UART_NUM, &uart_config);
     uart_set_pin(JETSON_UART_NUM, JETSON_UART_TX_PIN, JETSON_UART_RX_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
-    uart_driver_install(JETSON_UART_NUM, 2048, 0, 0, NULL, 0);
+    uart_driver_install(JETSON_UART_NUM, 2048, 0, 10, &s_uart_queue, 0);
 }
 
-// 透過 UART 發送 JSON 字串
+// 透過 UART 發送 JSON 字串 (組成單一封包後一次寫入)
 void comms_uart_send_status(const char *json) {
     if (!json) return;
-    uart_write_bytes(JETSON_UART_NUM, json, strlen(json));
-    uart_write_bytes(JETSON_UART_NUM, "\n", 1); // 補上換行符號
+    char frame[CTRL_FRAME_MAX];
+    int n = ctrl_frame_encode(json, strlen(json), frame, sizeof(frame));
+    if (n > 0) uart_write_bytes(JETSON_UART_NUM, frame, n);
+}
+
+// UART 接收任務：消耗 Jetson 傳來的資料並切成封包，同時通知狀態任務「有活動」(避免進入閒置)
+// 目前尚未定義 Jetson -> ESP32 的指令，收到的行只記錄長度
+static void uart_rx_task(void *arg) {
+    ctrl_frame_decoder_t dec;
+    ctrl_frame_decoder_init(&dec);
+    uint8_t buf[128];
+    uart_event_t ev;
+    while (1) {
+        if (xQueueReceive(s_uart_queue, &ev, portMAX_DELAY) != pdTRUE) continue;
+        if (ev.type == UART_FIFO_OVF || ev.type == UART_BUFFER_FULL) {
+            uart_flush_input(JETSON_UART_NUM);
+            xQueueReset(s_uart_queue);
+            ctrl_frame_decoder_init(&dec);
+            continue;
+        }
+        if (ev.type != UART_DATA) continue;
+
+        size_t remaining = ev.size;
+        while (remaining > 0) {
+            int n = uart_read_bytes(JETSON_UART_NUM, buf, MIN(remaining, sizeof(buf)), 0);
+            if (n <= 0) break;
+            remaining -= n;
+            for (size_t pos = 0; pos < (size_t)n; ) {
+                const char *line;
+                size_t line_len;
+                pos += ctrl_frame_decode(&dec, buf + pos, n - pos, &line, &line_len);
+                if (line) DLOG(UART_RX_LINE, line_len);
+            }
+        }
+        if (s_status_task) xTaskNotify(s_status_task, STATUS_EVT_UART, eSetBits);
+    }
 }
 
 // 讀取電位器數值 (使用 ADC OneShot 模式)
@@ -297,8 +353,167 @@ static int read_pot_raw(int which) {
     return raw;
 }
 
+// 一次讀取所有 GPIO 電位 (兩次暫存器讀取取代逐腳 gpio_get_level) 並解碼成快照
+// read_pots = false 時不觸發 ADC 轉換，電位器欄位填 0
+// 回傳取樣時的原始電位位元圖 (bit n = GPIO n)，供喚醒條件依同一份取樣佈署
+static uint64_t io_snapshot_read(io_snapshot_t *snap, bool read_pots) {
+    uint64_t levels = (uint64_t)REG_READ(GPIO_IN_REG) | ((uint64_t)REG_READ(GPIO_IN1_REG) << 32);
+    ctrl_snapshot_decode(levels, read_pots ? read_pot_raw(2) : 0, read_pots ? read_pot_raw(3) : 0, snap);
+    return levels;
+}
+
+/* ==========================================================
+ * 4. 電源管理 (DFS / 自動 Light Sleep / 喚醒)
+ * ========================================================== */
+
+// DFS 最低頻率 (MHz)：閒置時降到 XTAL 頻率
+#define PM_MIN_FREQ_MHZ     CONFIG_XTAL_FREQ
+// UART 喚醒門檻 (RX 邊緣數)；觸發喚醒的字元會被丟棄
+#define UART_WAKE_THRESHOLD 3
+
+static power_policy_t s_power;                // 閒置策略狀態 (只由 status_task 更新)
+static esp_pm_lock_handle_t s_pm_lock = NULL; // ACTIVE 時持有：維持最高頻率並禁止 light sleep
+static volatile bool s_idle = false;          // 給 ISR 讀取的閒置旗標
+// 喚醒時間戳 (0 = 無)：64 位元在 32 位元 Xtensa 上非原子，讀寫一律在 s_wake_mux 內
+static portMUX_TYPE s_wake_mux = portMUX_INITIALIZER_UNLOCKED;
+static int64_t s_wake_edge_us = 0;            // 閒置中第一個輸入邊緣進入 GPIO ISR 的時間
+static int64_t s_sleep_exit_us = 0;           // 閒置中最近一次 light sleep 離開的時間
+
+// 會喚醒系統的輸入腳位 (A1/B1/B4/B5/C 系列；不含 ADC 與 Z1)
+static const gpio_num_t s_wake_pins[] = {
+    A1_1_GPIO, A1_2_GPIO, B1_1_GPIO, B1_2_GPIO, B4_GPIO, B5_GPIO,
+    C1_1_GPIO, C1_2_GPIO, C1_3_GPIO, C1_4_GPIO, C2_1_GPIO, C2_2_GPIO, C2_3_GPIO, C2_4_GPIO,
+    C3_1_GPIO, C3_2_GPIO, C3_3_GPIO, C3_4_GPIO, C4_1_GPIO, C4_2_GPIO,
+};
+
+static uint32_t now_ms(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+// GPIO 中斷：電位觸發，先關閉該腳中斷再通知狀態任務重新佈署
+static void wake_gpio_isr(void *arg) {
+    gpio_intr_disable((gpio_num_t)(intptr_t)arg);
+    if (s_idle) {
+        int64_t now = esp_timer_get_time();
+        portENTER_CRITICAL_ISR(&s_wake_mux);
+        if (s_wake_edge_us == 0) s_wake_edge_us = now;
+        portEXIT_CRITICAL_ISR(&s_wake_mux);
+    }
+    BaseType_t hp_woken = pdFALSE;
+    if (s_status_task) xTaskNotifyFromISR(s_status_task, STATUS_EVT_GPIO, eSetBits, &hp_woken);
+    portYIELD_FROM_ISR(hp_woken);
+}
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+// light sleep 離開回呼 (中斷關閉中執行，須在 IRAM)：
+// 比 GPIO ISR 更早，涵蓋喚醒後的時間校正、頻率切換與等待中斷派送的時間
+static esp_err_t IRAM_ATTR power_sleep_exit_cb(int64_t slept_us, void *arg) {
+    if (s_idle) {
+        int64_t now = esp_timer_get_time();
+        portENTER_CRITICAL_SAFE(&s_wake_mux);
+        s_sleep_exit_us = now;
+        portEXIT_CRITICAL_SAFE(&s_wake_mux);
+    }
+    return ESP_OK;
+}
+#endif
+
+// 喚醒延遲的量測起點 (回報於 /power)：sleep 離開回呼，不含其前的硬體喚醒時間；未啟用回呼時為 GPIO ISR
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+#define WAKE_LATENCY_FROM "sleep_exit_cb"
+#else
+#define WAKE_LATENCY_FROM "gpio_isr"
+#endif
+
+// 取出並清除喚醒時間戳，回傳延遲量測的起點 (0 = 本輪沒有閒置中的邊緣)
+// 必須在讀取輸入快照「之前」呼叫：取出前發生的邊緣都已反映在快照中，之後的留給下一輪
+static int64_t power_take_wake_edge(void) {
+    portENTER_CRITICAL(&s_wake_mux);
+    int64_t edge = s_wake_edge_us;
+    int64_t sleep_exit = s_sleep_exit_us;
+    s_wake_edge_us = 0;
+    s_sleep_exit_us = 0;
+    portEXIT_CRITICAL(&s_wake_mux);
+
+    // 由 GPIO 從 light sleep 喚醒時，以較早的 sleep 離開時間為起點
+    if (edge != 0 && sleep_exit != 0 && sleep_exit < edge &&
+        esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO) {
+        edge = sleep_exit;
+    }
+    return edge;
+}
+
+// 依快照取樣時的電位 (levels，bit n = GPIO n) 設定「相反電位」觸發
+// (light sleep 只支援電位喚醒，每次變化後重新佈署即等效於任一邊緣喚醒)
+// 必須用快照的電位而非重新讀腳位：若腳位在快照之後、佈署之前改變 (開關彈跳最常見)，
+// 重新讀取會佈署成「新電位的相反」而不觸發，快照又仍是舊值 -> 變化被漏掉直到下次輪詢。
+// 依快照佈署時，取樣後的任何變化都會讓電位中斷立即觸發。
+static void power_wake_arm(uint64_t levels) {
+    for (size_t i = 0; i < sizeof(s_wake_pins) / sizeof(s_wake_pins[0]); i++) {
+        gpio_num_t pin = s_wake_pins[i];
+        gpio_wakeup_enable(pin, ((levels >> pin) & 1u) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+        gpio_intr_enable(pin);
+    }
+}
+
+// 套用策略狀態：ACTIVE 持有 PM lock，IDLE 釋放讓系統降頻並自動 light sleep
+static void power_apply_state(void) {
+    bool idle = (s_power.state == POWER_STATE_IDLE);
+    s_idle = idle;
+    if (s_pm_lock) {
+        if (idle) esp_pm_lock_release(s_pm_lock);
+        else esp_pm_lock_acquire(s_pm_lock);
+    }
+    DLOG(POWER_STATE, idle);
+}
+
+// 閒置後第一次送出 UART 時呼叫：計算「輸入邊緣 (或 sleep 離開) -> UART」延遲並檢查預算
+// 註：sleep 離開回呼之前的硬體喚醒 (CPU 上電、時脈穩定、cache 還原) 無法以軟體計時，不計入
+static void power_check_wake_latency(int64_t edge) {
+    if (edge == 0) return;
+    uint32_t latency_us = (uint32_t)(esp_timer_get_time() - edge);
+    if (power_policy_record_wake_latency(&s_power, latency_us)) DLOG(WAKE_LATENCY, latency_us, s_power.cfg.wake_budget_us);
+    else DLOG(WAKE_OVER_BUDGET, latency_us, s_power.cfg.wake_budget_us);
+}
+
+// 初始化電源管理 (須在 io_init 與 comms_uart_init 之後)
+static void power_init(void) {
+    power_policy_init(&s_power, NULL, now_ms());
+
+    esp_pm_config_t pm_cfg = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = PM_MIN_FREQ_MHZ,
+        .light_sleep_enable = true,
+    };
+    esp_err_t err = esp_pm_configure(&pm_cfg);
+    if (err != ESP_OK) ESP_LOGW(TAG, "PM configure failed (%s), running at fixed frequency", esp_err_to_name(err));
+
+    // 開機時為 ACTIVE
+    if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "ctrl_active", &s_pm_lock) == ESP_OK) {
+        esp_pm_lock_acquire(s_pm_lock);
+    }
+
+    // GPIO：任一輸入變化都會喚醒並通知狀態任務
+    gpio_install_isr_service(0);
+    for (size_t i = 0; i < sizeof(s_wake_pins) / sizeof(s_wake_pins[0]); i++) {
+        gpio_isr_handler_add(s_wake_pins[i], wake_gpio_isr, (void *)(intptr_t)s_wake_pins[i]);
+    }
+    io_snapshot_t snap;
+    power_wake_arm(io_snapshot_read(&snap, false));
+    esp_sleep_enable_gpio_wakeup();
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+    esp_pm_sleep_cbs_register_config_t cbs = { .exit_cb = power_sleep_exit_cb };
+    if (esp_pm_light_sleep_register_cbs(&cbs) != ESP_OK) ESP_LOGW(TAG, "Light sleep exit callback not registered");
+#endif
+
+    // UART：Jetson 傳資料時喚醒
+    if (uart_set_wakeup_threshold(JETSON_UART_NUM, UART_WAKE_THRESHOLD) != ESP_OK) ESP_LOGW(TAG, "UART wakeup threshold not set");
+    else if (esp_sleep_enable_uart_wakeup(JETSON_UART_NUM) != ESP_OK) ESP_LOGW(TAG, "UART wakeup not available");
+}
+
 /* ==========================================================
- * 4. OTA 線上更新功能
+ * 5. OTA 線上更新功能
  * ========================================================== */
 
 // OTA 下載任務
@@ -315,13 +530,22 @@ static void ota_task(void *arg) {
     };
     
     esp_https_ota_config_t ota_config = { .http_config = &http_cfg };
+
+    // 下載期間維持最高頻率，避免閒置策略降頻拖慢更新
+    esp_pm_lock_handle_t ota_lock = NULL;
+    if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "ota", &ota_lock) == ESP_OK) esp_pm_lock_acquire(ota_lock);
     
-    if (esp_https_ota(&ota_config) == ESP_OK) {
-        ESP_LOGI(TAG, "OTA Success, Rebooting...");
+    esp_err_t err = esp_https_ota(&ota_config);
+    if (ota_lock) {
+        esp_pm_lock_release(ota_lock);
+        esp_pm_lock_delete(ota_lock);
+    }
+    if (err == ESP_OK) {
+        DLOG(OTA_OK);
         vTaskDelay(pdMS_TO_TICKS(1000));
         esp_restart();
     } else {
-        ESP_LOGE(TAG, "OTA Failed");
+        DLOG(OTA_FAIL, err);
     }
     free(url);
     vTaskDelete(NULL);
@@ -335,7 +559,7 @@ void ota_start(const char *url) {
 }
 
 /* ==========================================================
- * 5. Web Server (API 與 網頁)
+ * 6. Web Server (API 與 網頁)
  * ========================================================== */
 
 // GET / : 讀取 index.html 並回傳
@@ -356,23 +580,15 @@ static esp_err_t root_get_handler(httpd_req_t *req) {
 
 // GET /status : 回傳所有 IO 狀態的 JSON
 static esp_err_t status_get_handler(httpd_req_t *req) {
-    char buf[512];
-    int b2 = read_pot_raw(2);
-    int b3 = read_pot_raw(3);
-    
-    // 組裝 JSON 字串
-    // 注意：io_read_pin 的回傳值 0/1 代表 Low/High
-    snprintf(buf, sizeof(buf), 
-        "{\"A1_1\":%d,\"A1_2\":%d,\"A2\":%d,\"A3\":%d,\"A4\":%d,"
-        "\"B1_1\":%d,\"B1_2\":%d,\"B4\":%d,\"B5\":%d,\"B2_pot\":%d,\"B3_pot\":%d,"
-        "\"C1\":[%d,%d,%d,%d],\"C2\":[%d,%d,%d,%d],\"C3\":[%d,%d,%d,%d],\"C4\":[%d,%d]}",
-        io_read_pin(A1_1_GPIO), io_read_pin(A1_2_GPIO), io_read_pin(A2_GPIO), io_read_pin(A3_GPIO), io_read_pin(A4_GPIO),
-        io_read_pin(B1_1_GPIO), io_read_pin(B1_2_GPIO), io_read_pin(B4_GPIO), io_read_pin(B5_GPIO), b2, b3,
-        io_read_pin(C1_1_GPIO),io_read_pin(C1_2_GPIO),io_read_pin(C1_3_GPIO),io_read_pin(C1_4_GPIO),
-        io_read_pin(C2_1_GPIO),io_read_pin(C2_2_GPIO),io_read_pin(C2_3_GPIO),io_read_pin(C2_4_GPIO),
-        io_read_pin(C3_1_GPIO),io_read_pin(C3_2_GPIO),io_read_pin(C3_3_GPIO),io_read_pin(C3_4_GPIO),
-        io_read_pin(C4_1_GPIO),io_read_pin(C4_2_GPIO)
-    );
+    char buf[CTRL_STATUS_MAX];
+    io_snapshot_t snap;
+    io_snapshot_read(&snap, true);
+
+    // 組裝 JSON 字串 (0/1 代表 Low/High)
+    if (ctrl_status_serialize(&snap, buf, sizeof(buf)) < 0) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
 
     httpd_resp_set_type(req, "application/json");
     httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
@@ -382,6 +598,23 @@ static esp_err_t status_get_handler(httpd_req_t *req) {
     return ESP_OK;
 }
 
+// GET /power : 回傳電源狀態與喚醒延遲統計
+static esp_err_t power_get_handler(httpd_req_t *req) {
+    char buf[256];
+    power_policy_t p = s_power; // 複製一份，避免輸出途中被 status_task 更新
+    snprintf(buf, sizeof(buf),
+        "{\"state\":\"%s\",\"idle_for_ms\":%lu,\"wake_count\":%lu,"
+        "\"wake_latency_us\":{\"last\":%lu,\"max\":%lu,\"count\":%lu,\"over_budget\":%lu,\"budget\":%lu,"
+        "\"from\":\"%s\"}}",
+        p.state == POWER_STATE_IDLE ? "idle" : "active",
+        (unsigned long)(now_ms() - p.last_activity_ms), (unsigned long)p.wake_count,
+        (unsigned long)p.lat_last_us, (unsigned long)p.lat_max_us, (unsigned long)p.lat_count,
+        (unsigned long)p.lat_over_budget, (unsigned long)p.cfg.wake_budget_us, WAKE_LATENCY_FROM);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
+    return ESP_OK;
+}
+
 // POST /ota : 接收網頁傳來的 URL 並觸發更新
 static esp_err_t ota_post_handler(httpd_req_t *req) {
     char buf[256];
@@ -434,78 +667,307 @@ static esp_err_t api_save_wifi_handler(httpd_req_t *req) {
     return ESP_OK;
 }
 
+/* --- 延遲式日誌 (DLOG) 查看介面 --- */
+
+static httpd_handle_t s_server = NULL;    // Web Server 句柄 (WebSocket 非同步發送用)
+static TaskHandle_t s_log_task = NULL;
+
+// 即時日誌訂閱者 (每個 WebSocket 各自一個讀取游標)；滿了時關閉最舊的連線，不留下收不到資料的連線
+#define LOG_WS_MAX_CLIENTS 3
+typedef struct {
+    int fd;           // -1 = 空槽
+    uint32_t order;   // 加入順序 (選出最舊者)
+    bool fresh;       // 新加入，推送任務需先補送歷史記錄
+    uint32_t cursor;  // 只由 log_stream_task 使用
+} log_ws_client_t;
+static log_ws_client_t s_log_ws[LOG_WS_MAX_CLIENTS] = {
+    [0 ... LOG_WS_MAX_CLIENTS - 1] = { .fd = -1 },
+};
+static portMUX_TYPE s_log_ws_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// 文字批次緩衝：把多行日誌湊成一包再送出，減少 TCP 封包數
+typedef struct {
+    char buf[1024];
+    size_t len;
+    esp_err_t err;
+    esp_err_t (*flush)(void *arg, const char *data, size_t len);
+    void *arg;
+} log_text_buf_t;
+
+static void log_text_flush(log_text_buf_t *tb) {
+    if (tb->len > 0 && tb->err == ESP_OK) tb->err = tb->flush(tb->arg, tb->buf, tb->len);
+    tb->len = 0;
+}
+
+// dlog_drain 回呼：格式化一筆記錄並加入緩衝
+static void log_text_sink(const dlog_record_t *rec, void *ctx) {
+    log_text_buf_t *tb = (log_text_buf_t *)ctx;
+    char line[160];
+    int n = dlog_format_record(rec, line, sizeof(line) - 1);
+    line[n++] = '\n';
+    if (tb->len + n > sizeof(tb->buf)) log_text_flush(tb);
+    memcpy(tb->buf + tb->len, line, n);
+    tb->len += n;
+}
+
+static esp_err_t log_chunk_flush(void *arg, const char *data, size_t len) {
+    return httpd_resp_send_chunk((httpd_req_t *)arg, data, len);
+}
+
+static esp_err_t log_ws_flush(void *arg, const char *data, size_t len) {
+    httpd_ws_frame_t frame = {
+        .final = true,
+        .type = HTTPD_WS_TYPE_TEXT,
+        .payload = (uint8_t *)data,
+        .len = len,
+    };
+    return httpd_ws_send_frame_async(s_server, (int)(intptr_t)arg, &frame);
+}
+
+// GET /log : 以文字回傳環形緩衝區內所有記錄
+static esp_err_t log_get_handler(httpd_req_t *req) {
+    httpd_resp_set_type(req, "text/plain");
+    log_text_buf_t tb = { .flush = log_chunk_flush, .arg = req };
+    uint32_t cursor = dlog_oldest();
+    dlog_drain(&cursor, log_text_sink, &tb);
+    log_text_flush(&tb);
+    httpd_resp_send_chunk(req, NULL, 0);
+    return ESP_OK;
+}
+
+// GET /log/raw : 匯出二進位環形緩衝區 (用 tools/dlog_decode 解碼)
+static esp_err_t log_raw_get_handler(httpd_req_t *req) {
+    dlog_dump_hdr_t hdr;
+    dlog_dump_begin(&hdr);
+
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"dlog.bin\"");
+    httpd_resp_send_chunk(req, (const char *)&hdr, sizeof(hdr));
+
+    // 每次送 16 筆；讀不到的 (寫入中/已覆寫) 以 0 填充，解碼端會標示為遺失
+    dlog_record_t recs[16];
+    uint32_t seq = hdr.head - hdr.slot_count;
+    while (seq != hdr.head) {
+        uint32_t n = MIN(16, hdr.head - seq);
+        dlog_dump_read(seq, recs, n);
+        seq += n;
+        if (httpd_resp_send_chunk(req, (const char *)recs, n * sizeof(dlog_record_t)) != ESP_OK) return ESP_FAIL;
+    }
+    httpd_resp_send_chunk(req, NULL, 0);
+    return ESP_OK;
+}
+
+// GET /log/bench?n=100 : 比較 DLOG() 與 ESP_LOGI() 每次呼叫耗時
+static esp_err_t log_bench_get_handler(httpd_req_t *req) {
+    int n = 100;
+    char query[32], val[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "n", val, sizeof(val)) == ESP_OK) {
+        n = atoi(val);
+    }
+    n = MAX(1, MIN(n, 1000));
+
+    uint32_t dlog_ns = 0, esp_log_ns = 0;
+    int log_n = 0;
+    if (dlog_benchmark(n, &dlog_ns, &esp_log_ns, &log_n) != ESP_OK) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+
+    char buf[160];
+    snprintf(buf, sizeof(buf), "{\"iterations\":%d,\"dlog_ns\":%lu,\"esp_log_iterations\":%d,\"esp_log_ns\":%lu}",
+             n, (unsigned long)dlog_ns, log_n, (unsigned long)esp_log_ns);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
+    return ESP_OK;
+}
+
+// WS /ws/log : 即時日誌串流 (握手後由 log_stream_task 推送)
+static esp_err_t log_ws_handler(httpd_req_t *req) {
+    if (req->method == HTTP_GET) {
+        // 握手完成：登記訂閱者 (沒有空槽時取代最舊的) 並喚醒推送任務
+        static uint32_t s_order = 0;
+        int fd = httpd_req_to_sockfd(req);
+        int evict_fd = -1;
+        portENTER_CRITICAL(&s_log_ws_mux);
+        log_ws_client_t *slot = &s_log_ws[0];
+        for (int i = 0; i < LOG_WS_MAX_CLIENTS; i++) {
+            log_ws_client_t *c = &s_log_ws[i];
+            if (c->fd < 0) { slot = c; break; }
+            if (c->order < slot->order) slot = c;
+        }
+        evict_fd = slot->fd;
+        slot->fd = fd;
+        slot->order = ++s_order;
+        slot->fresh = true;
+        portEXIT_CRITICAL(&s_log_ws_mux);
+        if (evict_fd >= 0) {
+            ESP_LOGW(TAG, "Log stream full, closing oldest client (fd %d)", evict_fd);
+            httpd_sess_trigger_close(req->handle, evict_fd);
+        }
+        if (s_log_task) xTaskNotifyGive(s_log_task);
+        return ESP_OK;
+    }
+    // 客戶端送來的資料一律讀掉丟棄
+    uint8_t buf[64];
+    httpd_ws_frame_t frame = { .payload = buf };
+    if (httpd_ws_recv_frame(req, &frame, 0) != ESP_OK || frame.len > sizeof(buf)) return ESP_FAIL;
+    return httpd_ws_recv_frame(req, &frame, frame.len);
+}
+
+// 移除訂閱者 (僅在槽位仍是同一個 fd 時；期間可能已被新連線取代)
+static void log_ws_remove(int idx, int fd) {
+    portENTER_CRITICAL(&s_log_ws_mux);
+    if (s_log_ws[idx].fd == fd) s_log_ws[idx].fd = -1;
+    portEXIT_CRITICAL(&s_log_ws_mux);
+}
+
+// 日誌推送任務 (低優先權)：只有在有人訂閱時才格式化，否則完全休眠
+static void log_stream_task(void *arg) {
+    bool any = false;
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, any ? pdMS_TO_TICKS(200) : portMAX_DELAY);
+
+        any = false;
+        for (int i = 0; i < LOG_WS_MAX_CLIENTS; i++) {
+            log_ws_client_t *c = &s_log_ws[i];
+            portENTER_CRITICAL(&s_log_ws_mux);
+            int fd = c->fd;
+            bool fresh = c->fresh;
+            c->fresh = false;
+            portEXIT_CRITICAL(&s_log_ws_mux);
+            if (fd < 0) continue;
+
+            if (httpd_ws_get_fd_info(s_server, fd) != HTTPD_WS_CLIENT_WEBSOCKET) {
+                log_ws_remove(i, fd); // 客戶端已離線
+                continue;
+            }
+            if (fresh) c->cursor = dlog_oldest(); // 新的訂閱者：先補送緩衝區內的歷史記錄
+
+            log_text_buf_t tb = { .flush = log_ws_flush, .arg = (void *)(intptr_t)fd };
+            uint32_t lost = dlog_drain(&c->cursor, log_text_sink, &tb);
+            if (lost > 0) {
+                log_text_flush(&tb);
+                tb.len = snprintf(tb.buf, sizeof(tb.buf), "... %lu records overwritten\n", (unsigned long)lost);
+            }
+            log_text_flush(&tb);
+            if (tb.err != ESP_OK) {
+                // 傳送失敗：關閉連線，讓瀏覽器顯示離線而不是停在「連線中」
+                log_ws_remove(i, fd);
+                httpd_sess_trigger_close(s_server, fd);
+                continue;
+            }
+            any = true;
+        }
+    }
+}
+
 // 啟動 Web Server
 static void start_webserver(void) {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
-    config.max_uri_handlers = 8;
+    config.max_uri_handlers = 12;
     httpd_handle_t server = NULL;
     if (httpd_start(&server, &config) == ESP_OK) {
+        s_server = server;
         // 註冊 URI 路徑
         httpd_uri_t root = { .uri = "/", .method = HTTP_GET, .handler = root_get_handler };
         httpd_uri_t status = { .uri = "/status", .method = HTTP_GET, .handler = status_get_handler };
+        httpd_uri_t power = { .uri = "/power", .method = HTTP_GET, .handler = power_get_handler };
         httpd_uri_t ota = { .uri = "/ota", .method = HTTP_POST, .handler = ota_post_handler };
         httpd_uri_t wifi = { .uri = "/api/save_wifi", .method = HTTP_POST, .handler = api_save_wifi_handler };
+        httpd_uri_t log_txt = { .uri = "/log", .method = HTTP_GET, .handler = log_get_handler };
+        httpd_uri_t log_raw = { .uri = "/log/raw", .method = HTTP_GET, .handler = log_raw_get_handler };
+        httpd_uri_t log_bench = { .uri = "/log/bench", .method = HTTP_GET, .handler = log_bench_get_handler };
+        httpd_uri_t log_ws = { .uri = "/ws/log", .method = HTTP_GET, .handler = log_ws_handler, .is_websocket = true };
         
         httpd_register_uri_handler(server, &root);
         httpd_register_uri_handler(server, &status);
+        httpd_register_uri_handler(server, &power);
         httpd_register_uri_handler(server, &ota);
         httpd_register_uri_handler(server, &wifi);
+        httpd_register_uri_handler(server, &log_txt);
+        httpd_register_uri_handler(server, &log_raw);
+        httpd_register_uri_handler(server, &log_bench);
+        httpd_register_uri_handler(server, &log_ws);
         ESP_LOGI(TAG, "Web Server Started");
     }
 }
 
 /* ==========================================================
- * 6. 主程式 (Main) 與 狀態迴圈
+ * 7. 主程式 (Main) 與 狀態迴圈
  * ========================================================== */
 
-// 狀態更新任務 (處理燈號邏輯與蜂鳴器)
+// 輸入改變時主動把狀態推送給 Jetson (送出的就是狀態任務據以動作的那份快照)
+static void status_publish(const io_snapshot_t *snap) {
+    char buf[CTRL_STATUS_MAX];
+    if (ctrl_status_serialize(snap, buf, sizeof(buf)) >= 0) comms_uart_send_status(buf);
+}
+
+// 狀態更新任務 (處理燈號邏輯、蜂鳴器與閒置判斷)
+// 由 GPIO 中斷 / UART 接收通知喚醒；ACTIVE 時每 200ms 輪詢，IDLE 時拉長週期讓系統進入 light sleep
 static void status_task(void *arg) {
     static int stored_vals[3] = {0,0,0}; 
+    ctrl_mode_t prev_mode = (ctrl_mode_t)-1;
+    io_snapshot_t snap, prev_snap;
+    bool first = true;
     while(1) {
-        // --- 1. 電源端邏輯 (控制 LED) ---
-        // 根據 A1_1 和 A1_2 的狀態決定 A2/A3/A4 哪個亮
-        int a1_1 = io_read_pin(A1_1_GPIO);
-        int a1_2 = io_read_pin(A1_2_GPIO);
-        
-        // 邏輯表 (依據你的硬體設計)
-        if (a1_1 && a1_2) { 
-            // 兩者皆高 -> 自動模式 (A2 亮)
-            io_write_pin(A2_GPIO,1); io_write_pin(A3_GPIO,0); io_write_pin(A4_GPIO,0); 
-        }
-        else if (a1_1) { 
-            // 僅 A1_1 高 -> 手動模式 (A3 亮)
-            io_write_pin(A2_GPIO,0); io_write_pin(A3_GPIO,1); io_write_pin(A4_GPIO,0); 
-        }
-        else if (a1_2) { 
-            // 僅 A1_2 高 -> 搖桿模式 (A4 亮)
-            io_write_pin(A2_GPIO,0); io_write_pin(A3_GPIO,0); io_write_pin(A4_GPIO,1); 
+        uint32_t events = 0;
+        if (!first) xTaskNotifyWait(0, UINT32_MAX, &events, pdMS_TO_TICKS(power_policy_poll_ms(&s_power)));
+
+        int64_t wake_edge = power_take_wake_edge(); // 先取時間戳再讀快照 (見函式註解)
+        uint64_t levels = io_snapshot_read(&snap, false); // 電位器只在需要時才讀
+        // 中斷觸發後以快照的電位重新佈署喚醒條件 (見 power_wake_arm 註解)
+        if (first || (events & STATUS_EVT_GPIO)) power_wake_arm(levels);
+
+        bool changed = first || ctrl_inputs_changed(&prev_snap, &snap);
+        prev_snap = snap;
+        first = false;
+
+        // --- 0. 閒置判斷 (輸入變化或 UART 有資料即視為活動) ---
+        if (power_policy_update(&s_power, now_ms(), changed || (events & STATUS_EVT_UART))) power_apply_state();
+
+        // 根據 A1_1 和 A1_2 的狀態決定 A2/A3/A4 哪個亮 (邏輯表見 ctrl_mode_from_a1)
+        ctrl_mode_t mode = ctrl_mode_from_a1(snap.a1_1, snap.a1_2);
+        uint8_t lamps = ctrl_mode_lamps(mode);
+
+        // --- 1. 輸入變化時立即推送狀態並檢查閒置喚醒延遲 (在蜂鳴器等延遲動作之前) ---
+        // 輸入沒有變化 (彈跳後回到原電位) 時，這次的時間戳直接捨棄
+        if (changed) {
+            snap.a2 = (lamps & CTRL_LAMP_A2) ? 1 : 0; // 送出本輪要點亮的燈號
+            snap.a3 = (lamps & CTRL_LAMP_A3) ? 1 : 0;
+            snap.a4 = (lamps & CTRL_LAMP_A4) ? 1 : 0;
+            snap.b2_pot = read_pot_raw(2);
+            snap.b3_pot = read_pot_raw(3);
+            status_publish(&snap);
+            power_check_wake_latency(wake_edge);
         }
-        else { 
-            // 全滅
-            io_write_pin(A2_GPIO,0); io_write_pin(A3_GPIO,0); io_write_pin(A4_GPIO,0); 
+
+        // --- 2. 電源端邏輯 (控制 LED) ---
+        if (mode != prev_mode) {
+            prev_mode = mode;
+            DLOG(MODE_CHANGE, snap.a1_1, snap.a1_2);
         }
+        io_write_pin(A2_GPIO, (lamps & CTRL_LAMP_A2) ? 1 : 0);
+        io_write_pin(A3_GPIO, (lamps & CTRL_LAMP_A3) ? 1 : 0);
+        io_write_pin(A4_GPIO, (lamps & CTRL_LAMP_A4) ? 1 : 0);
 
-        // --- 2. 選擇端邏輯 (B系列) ---
+        // --- 3. 選擇端邏輯 (B系列) ---
         // 僅在手動模式 (A3 亮時) 運作
-        if (io_read_pin(A3_GPIO)) {
-            // 切換開關 B4 決定讀取哪個電位器
-            int val = io_read_pin(B4_GPIO) ? read_pot_raw(3) : read_pot_raw(2);
-            
-            // 三檔位開關 B1 決定儲存目標索引 (0, 1, 2)
-            int idx = (io_read_pin(B1_1_GPIO)==0 && io_read_pin(B1_2_GPIO)==0) ? 0 :
-                      (io_read_pin(B1_1_GPIO)==0 && io_read_pin(B1_2_GPIO)==1) ? 1 : 2;
+        if (mode == CTRL_MODE_MANUAL) {
+            // B4 決定電位器、B1 決定儲存目標、B5 決定是否儲存
+            ctrl_select_t sel;
+            ctrl_select(&snap, &sel);
+            int val = read_pot_raw(sel.src);
             
             // 點動開關 B5 按下時 -> 儲存數值並鳴叫蜂鳴器
-            if (io_read_pin(B5_GPIO)) {
-                stored_vals[idx] = val;
+            if (sel.store) {
+                stored_vals[sel.idx] = val;
+                DLOG(SEL_STORE, sel.idx, val, sel.src);
                 io_write_pin(B6_GPIO, 1);       // 蜂鳴器響
                 vTaskDelay(pdMS_TO_TICKS(100)); // 響 100ms
                 io_write_pin(B6_GPIO, 0);       // 蜂鳴器停
             }
         }
-        
-        // 每 200ms 更新一次邏輯
-        vTaskDelay(pdMS_TO_TICKS(200));
     }
 }
 
@@ -519,6 +981,9 @@ void app_main(void)
         nvs_flash_init();
     }
 
+    // 初始化延遲式日誌 (之後的 WiFi/OTA 事件都會寫入環形緩衝區)
+    dlog_init();
+
     // 2. 載入儲存的設定 (WiFi/IP)
     load_settings();
 
@@ -539,6 +1004,7 @@ void app_main(void)
     // 5. 初始化硬體
     io_init();
     comms_uart_init();
+    power_init(); // DFS + 自動 light sleep，GPIO/UART 喚醒
 
     // 6. WiFi 初始化 (優先嘗試 STA，失敗則轉 AP)
     bool connected = wifi_init_sta();
@@ -554,5 +1020,9 @@ void app_main(void)
     else ESP_LOGW(TAG, "System in RESCUE Mode (AP: 192.168.4.1)");
 
     // 8. 啟動狀態邏輯任務
-    xTaskCreate(status_task, "status_task", 4096, NULL, 5, NULL);
+    xTaskCreate(status_task, "status_task", 4096, NULL, 5, &s_status_task);
+    xTaskCreate(uart_rx_task, "uart_rx", 3072, NULL, 4, NULL);
+
+    // 9. 啟動日誌推送任務 (最低優先權，僅在 /ws/log 有人連線時工作)
+    xTaskCreate(log_stream_task, "log_stream", 4096, NULL, 1, &s_log_task);
 }
\ No newline at end of file
@@ -0,0 +1,60 @@
+/*
+ * 閒置電源策略實作 (純運算，韌體與 host/ 測試共用)
+ */
+
+#include <string.h>
+#include "power_policy.h"
+
+void power_policy_default_cfg(power_policy_cfg_t *cfg)
+{
+    cfg->idle_timeout_ms = POWER_IDLE_TIMEOUT_MS;
+    cfg->active_poll_ms = POWER_ACTIVE_POLL_MS;
+    cfg->idle_poll_ms = POWER_IDLE_POLL_MS;
+    cfg->wake_budget_us = POWER_WAKE_BUDGET_US;
+}
+
+void power_policy_init(power_policy_t *p, const power_policy_cfg_t *cfg, uint32_t now_ms)
+{
+    memset(p, 0, sizeof(*p));
+    if (cfg) p->cfg = *cfg;
+    else power_policy_default_cfg(&p->cfg);
+    p->state = POWER_STATE_ACTIVE;
+    p->last_activity_ms = now_ms;
+}
+
+bool power_policy_update(power_policy_t *p, uint32_t now_ms, bool activity)
+{
+    if (activity) {
+        p->last_activity_ms = now_ms;
+        if (p->state == POWER_STATE_IDLE) {
+            p->state = POWER_STATE_ACTIVE;
+            p->wake_count++;
+            return true;
+        }
+        return false;
+    }
+
+    // 以無號差值計算，毫秒計數器溢位 (約 49 天) 時仍正確
+    if (p->state == POWER_STATE_ACTIVE && (uint32_t)(now_ms - p->last_activity_ms) >= p->cfg.idle_timeout_ms) {
+        p->state = POWER_STATE_IDLE;
+        return true;
+    }
+    return false;
+}
+
+uint32_t power_policy_poll_ms(const power_policy_t *p)
+{
+    return (p->state == POWER_STATE_IDLE) ? p->cfg.idle_poll_ms : p->cfg.active_poll_ms;
+}
+
+bool power_policy_record_wake_latency(power_policy_t *p, uint32_t latency_us)
+{
+    p->lat_count++;
+    p->lat_last_us = latency_us;
+    if (latency_us > p->lat_max_us) p->lat_max_us = latency_us;
+    if (latency_us > p->cfg.wake_budget_us) {
+        p->lat_over_budget++;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+/*
+ * 閒置電源策略 (純運算，不呼叫任何 ESP-IDF API)
+ * 決定何時從 ACTIVE (240MHz、禁止 light sleep、200ms 輪詢) 進入 IDLE
+ * (允許 DFS 降頻 + 自動 light sleep、僅靠 GPIO/UART 喚醒)，並統計喚醒延遲是否超出預算。
+ * 韌體 (main.c) 與主機端測試 (host/test) 共用。
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 多久沒有任何輸入變化 / UART 接收就進入閒置
+#ifndef POWER_IDLE_TIMEOUT_MS
+#define POWER_IDLE_TIMEOUT_MS 30000
+#endif
+
+// ACTIVE 時狀態迴圈的輪詢週期 (維持原本的 200ms)
+#ifndef POWER_ACTIVE_POLL_MS
+#define POWER_ACTIVE_POLL_MS 200
+#endif
+
+// IDLE 時的保底輪詢週期 (輸入變化由 GPIO 喚醒即時通知，這裡只是防呆)
+#ifndef POWER_IDLE_POLL_MS
+#define POWER_IDLE_POLL_MS 5000
+#endif
+
+// 閒置後「第一個輸入邊緣 -> UART 送出」的延遲預算 (微秒)
+#ifndef POWER_WAKE_BUDGET_US
+#define POWER_WAKE_BUDGET_US 20000
+#endif
+
+typedef enum {
+    POWER_STATE_ACTIVE = 0,
+    POWER_STATE_IDLE,
+} power_state_t;
+
+typedef struct {
+    uint32_t idle_timeout_ms;
+    uint32_t active_poll_ms;
+    uint32_t idle_poll_ms;
+    uint32_t wake_budget_us;
+} power_policy_cfg_t;
+
+typedef struct {
+    power_policy_cfg_t cfg;
+    power_state_t state;
+    uint32_t last_activity_ms;
+    uint32_t wake_count;            // IDLE -> ACTIVE 次數
+
+    // 喚醒延遲統計
+    uint32_t lat_count;
+    uint32_t lat_last_us;
+    uint32_t lat_max_us;
+    uint32_t lat_over_budget;       // 超出預算的次數
+} power_policy_t;
+
+// 以上方巨集填入預設設定
+void power_policy_default_cfg(power_policy_cfg_t *cfg);
+
+// 初始化 (cfg 為 NULL 時使用預設值)；初始狀態為 ACTIVE
+void power_policy_init(power_policy_t *p, const power_policy_cfg_t *cfg, uint32_t now_ms);
+
+// 每次取樣後呼叫；activity = 輸入有變化或 UART 有收到資料
+// 回傳 true 代表狀態改變 (呼叫端需套用對應的 PM lock)
+bool power_policy_update(power_policy_t *p, uint32_t now_ms, bool activity);
+
+// 目前狀態下，狀態迴圈應等待的最長時間
+uint32_t power_policy_poll_ms(const power_policy_t *p);
+
+// 記錄一次喚醒延遲；回傳 true 代表在預算內
+bool power_policy_record_wake_latency(power_policy_t *p, uint32_t latency_us);
+
+#ifdef __cplusplus
+}
+#endif
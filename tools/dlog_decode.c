@@ -0,0 +1,57 @@
+/*
+ * 延遲式日誌 (Deferred Log) 主機端解碼工具
+ * 將 GET /log/raw 匯出的二進位環形緩衝區還原成文字日誌 (依序號)。
+ *
+ * 編譯：由 host/ 建置產生 (cmake --build build_host --target dlog_decode)，
+ *       或手動 cc -O2 -Imain -o dlog_decode tools/dlog_decode.c main/dlog_ring.c
+ * 使用：curl -s http://192.168.2.123/log/raw -o ring.bin && ./dlog_decode ring.bin
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dlog_ring.h"
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <ring.bin>\n", argv[0]);
+        return 2;
+    }
+    FILE *f = fopen(argv[1], "rb");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    // 先以實際檔案大小驗證檔頭，再依驗證過的筆數配置記憶體
+    long file_len = -1;
+    if (fseek(f, 0, SEEK_END) == 0) file_len = ftell(f);
+    rewind(f);
+
+    dlog_dump_hdr_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    const char *err = "read error";
+    if (file_len >= 0 && fread(&hdr, 1, sizeof(hdr), f) == sizeof(hdr)) err = dlog_dump_check(&hdr, (size_t)file_len);
+    if (err) {
+        fprintf(stderr, "%s: %s\n", argv[1], err);
+        fclose(f);
+        return 1;
+    }
+
+    dlog_record_t *recs = calloc(hdr.slot_count ? hdr.slot_count : 1, sizeof(dlog_record_t));
+    if (!recs) {
+        fclose(f);
+        return 1;
+    }
+    size_t n = fread(recs, sizeof(dlog_record_t), hdr.slot_count, f);
+    fclose(f);
+    if (n != hdr.slot_count) {
+        fprintf(stderr, "%s: truncated\n", argv[1]);
+        free(recs);
+        return 1;
+    }
+
+    dlog_dump_decode(&hdr, recs, stdout);
+    free(recs);
+    return 0;
+}